@@ -30,11 +30,13 @@
 #include "libfolia/folia_utils.h"
 #include "libfolia/folia_textpolicy.h"
 #include "libfolia/folia_metadata.h"
+#include "libfolia/folia_arena.h"
 #include "libfolia/folia_impl.h"
 #include "libfolia/folia_subclasses.h"
 #include "libfolia/folia_document.h"
 #include "libfolia/folia_engine.h"
 #include "libfolia/folia_provenance.h"
+#include "libfolia/folia_input.h"
 using TiCC::operator<<;
 
 #endif
@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of libfolia
+
+  libfolia is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  libfolia is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/ticcutils/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+*/
+
+#ifndef FOLIA_ARENA_H
+#define FOLIA_ARENA_H
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <mutex>
+
+namespace folia {
+
+  /// a pool allocator for the FoliaElement nodes of one Document
+  /*!
+    Memory is handed out from large blocks. All blocks are released at once
+    when the arena is deleted. Single nodes are never given back: deleting a
+    node in an arena only runs its destructor, the slot stays in use until
+    the arena goes away.
+
+    An ElementArena is used by one thread at a time. A Document hands out
+    an arena per thread, see Document::element_arena(). All arenas of a
+    Document share one lock, which guards the list of blocks, so the
+    Document can check if a node lives in one of its arenas.
+
+    The arena only manages raw memory: it does NOT run destructors. The
+    Document that owns it takes care of that.
+
+    While an ElementArena::scope is active on a thread, all FoliaElement
+    nodes created with new on that thread are allocated in its arena.
+  */
+  class ElementArena {
+  public:
+    ElementArena( const void *, std::mutex&, size_t = 1024*1024 );
+    ~ElementArena();
+    void *allocate( size_t );
+    bool owns( const void * ) const;
+    static void orphan( const std::vector<ElementArena*>&, size_t );
+    static bool unpin( const void * );
+    /// the object (a Document) this arena belongs to
+    const void *owner() const { return _owner; };
+    /// the number of slots handed out
+    size_t size() const { return _live; };
+    /// the number of bytes reserved
+    size_t capacity() const { return _reserved; };
+    /// the arena in use by the current thread (may be 0)
+    static ElementArena *current() { return _current; };
+    /// RAII helper to route node allocations to an arena
+    class scope {
+    public:
+      explicit scope( ElementArena *a ): _previous( _current ){
+	_current = a;
+      };
+      ~scope(){ _current = _previous; };
+      scope( const scope& ) = delete;
+      scope& operator=( const scope& ) = delete;
+    private:
+      ElementArena *_previous;
+    };
+  private:
+    static thread_local ElementArena *_current;
+    const void *_owner;
+    std::mutex& _lock; ///< the lock of the owner, guards _blocks
+    size_t _block_size;
+    std::vector<std::pair<char*,char*>> _blocks; ///< sorted on address
+    char *_next;
+    char *_end;
+    size_t _live;
+    size_t _reserved;
+    ElementArena( const ElementArena& ) = delete; // inhibit copies
+    ElementArena& operator=( const ElementArena& ) = delete; // inhibit copies
+  };
+
+} // namespace folia
+
+#endif // FOLIA_ARENA_H
@@ -31,13 +31,19 @@
 #include <list>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <atomic>
 #include "unicode/unistr.h"
 #include "unicode/regex.h"
 #include "libxml/tree.h"
 #include "libxml/xpath.h"
+#include "libxml/xmlreader.h"
 #include "ticcutils/enum_flags.h"
 #include "ticcutils/LogStream.h"
 #include "libfolia/folia.h"
@@ -52,6 +58,7 @@ namespace folia {
 
   class Pattern {
     friend std::ostream& operator<<( std::ostream&, const Pattern& );
+    friend class compiled_pattern;
   public:
     // cppcheck-suppress noExplicitConstructor
     // We want to be able to use const char parameters AND string
@@ -82,6 +89,8 @@ namespace folia {
   class Paragraph;
   class processor;
   class Provenance;
+  class Decompressor;
+  class ElementArena;
 
   class Document {
     friend std::ostream& operator<<( std::ostream& os, const Document *d );
@@ -100,7 +109,10 @@ namespace folia {
       STRIP=8,         //!< on output, strip
       CANONICAL=16,    //!< sort ouput in a reproducable way.
       AUTODECLARE=32,  //!< Automagicly add missing Annotation Declarations
-      EXPLICIT=64      //!< add all set information
+      EXPLICIT=64,     //!< add all set information
+      STREAM=128,      //!< parse directly from an xmlTextReader, without a DOM
+      ARENA=256,       //!< allocate the FoliaElement nodes in an ElementArena
+      CACHETEXT=512    //!< remember the results of text() per node
     };
     enum class DEBUG_FLAGS {
       NODEBUG=0,            //!< nodebug.
@@ -184,6 +196,39 @@ namespace folia {
     Paragraph *rparagraphs( size_t ) const;
     Sentence *sentences( size_t ) const;
     Sentence *rsentences( size_t ) const;
+    size_t word_count() const;
+    size_t word_position( const Word * ) const;
+    std::vector<AbstractSpanAnnotation*> spans_of( const FoliaElement * ) const;
+    void invalidate_index() const {
+      /// forget all cached Word, Sentence and Paragraph lists.
+      /// Called when the root of the Document's tree is replaced
+      _index_dirty.fetch_or( _index_built.load( std::memory_order_relaxed ),
+			     std::memory_order_relaxed );
+    }
+    bool span_index_outdated() const {
+      /// true when a change in the tree marked the span index.
+      /// The next spans_of() rebuilds it
+      return index_outdated( doc_index::SPANS );
+    }
+    bool word_index_outdated() const {
+      /// true when a change in the tree marked the positions of the Words.
+      /// The next word_position() or word_count() rebuilds them
+      return index_outdated( doc_index::WORD_POSITIONS );
+    }
+    void invalidate_index( const FoliaElement *, const FoliaElement * ) const;
+    template <typename F>
+    select_range<F> each( const std::set<ElementType>& exclude = default_ignore,
+			  SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
+      /// a lazy range over all F nodes in the Document. See FoliaElement::each()
+      return foliadoc->each<F>( exclude, flag );
+    }
+    template <typename F, typename Fn>
+    bool for_each( Fn fn,
+		   const std::set<ElementType>& exclude = default_ignore,
+		   SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
+      /// call fn for all F nodes in the Document. See FoliaElement::for_each()
+      return foliadoc->for_each<F>( fn, exclude, flag );
+    }
     std::string toXml( const std::string& ="" ) const;
     bool toXml( const std::string&,
 		const std::string& ) const;
@@ -259,6 +304,10 @@ namespace folia {
 	\param p the FoliaElement to keep for later annihilation
 	the delSet is kept until the destruction of the Document
        */
+      if ( _parse_job ){
+	_parse_job->deletions.push_back( p );
+	return;
+      }
       delSet.insert( p );
     };
     void addExternal( External *p ) {
@@ -266,6 +315,10 @@ namespace folia {
       /*!
 	\param p The node to add
       */
+      if ( _parse_job ){
+	_parse_job->externals.push_back( p );
+	return;
+      }
       _externals.push_back( p );
     };
     void resolveExternals();
@@ -285,6 +338,12 @@ namespace folia {
     bool autodeclare() const;
     /// is the EXPLICITE mode set?
     bool has_explicit() const;
+    /// is the STREAM mode set?
+    bool streaming() const;
+    /// is the ARENA mode set?
+    bool arena() const;
+    /// is the CACHETEXT mode set?
+    bool cachetext() const;
     bool set_permissive( bool ) const; // defined const, but the mode is mutable!
     bool set_checktext( bool ) const; // defined const, but the mode is mutable!
     bool set_fixtext( bool ) const; // defined const, but the mode is mutable!
@@ -292,6 +351,36 @@ namespace folia {
     bool set_canonical( bool ) const; // defined const, but the mode is mutable!
     bool set_autodeclare( bool ) const; // defined const, but the mode is mutable!
     bool set_explicit( bool ) const; // defined const, but the mode is mutable!
+    bool set_streaming( bool ) const; // defined const, but the mode is mutable!
+    bool set_arena( bool ) const; // defined const, but the mode is mutable!
+    bool set_cachetext( bool ) const; // defined const, but the mode is mutable!
+    /// did any node cache its text() yet?
+    bool has_text_caches() const { return _has_text_caches; };
+    void register_text_cache() const { _has_text_caches = true; };
+    /// the lock that guards the cached texts of the nodes of this Document
+    std::mutex& text_cache_mutex() const { return _text_cache_mutex; };
+    /// a text() result remembered for a node, see CACHETEXT
+    struct cached_text {
+      std::string cls;
+      TEXT_FLAGS flags;
+      CORRECTION_HANDLING correction;
+      UnicodeString text;
+    };
+    using text_cache_map = std::unordered_map<const FoliaElement*,
+					      std::vector<cached_text>>;
+    /// the cached texts of all nodes. Only use while holding
+    /// text_cache_mutex()
+    text_cache_map& text_caches() const { return _text_caches; };
+    ElementArena *element_arena() const;
+    bool arena_node( const void * ) const;
+    void keep_detached( FoliaElement * );
+    void forget_detached( FoliaElement * );
+    /// the number of threads used to parse the body of a Document
+    unsigned int parse_threads() const { return _parse_threads; };
+    unsigned int set_parse_threads( unsigned int ) const;
+    bool parse_subtrees( const xmlNode * );
+    FoliaElement *merge_subtree( FoliaElement *, const xmlNode * );
+    void discard_subtrees();
     /// this class holds annotation declaration information
     class annotation_info {
       friend std::ostream& operator<<( std::ostream& os,
@@ -353,6 +442,10 @@ namespace folia {
 	on a call to validate_offsets() this buffer is used to validate
 	all offsets.
       */
+      if ( _parse_job ){
+	_parse_job->t_offsets.push_back( tc );
+	return;
+      }
       t_offset_validation_buffer.push_back( tc );
     }
     void cache_phoncontent( PhonContent *pc ){
@@ -362,6 +455,10 @@ namespace folia {
 	on a call to validate_offsets() this buffer is used to validate
 	all offsets.
       */
+      if ( _parse_job ){
+	_parse_job->p_offsets.push_back( pc );
+	return;
+      }
       p_offset_validation_buffer.push_back( pc );
     }
     bool validate_offsets() const;
@@ -412,15 +509,54 @@ namespace folia {
     void increment_warn_count() const {
       /// increment the warning count
       // NOTE: function is defined const, but the _warn_count is mutable
+      if ( _parse_job ){
+	++_parse_job->warn_count;
+	return;
+      }
       ++_warn_count;
     }
     void add_textclass( const std::string& tc ){
+      if ( _parse_job ){
+	_parse_job->textclasses.insert( tc );
+	return;
+      }
       _textclasses.insert( tc );
     }
     const std::set<std::string>& textclasses() const {
+      if ( _parse_job ){
+	return _parse_job->textclasses;
+      }
       return _textclasses;
     }
   private:
+    struct parse_job {
+      /// a subtree of the body, parsed in a worker thread
+      /*!
+	While parsing, all updates to the Document are collected here.
+	merge_subtree() applies them in document order afterwards
+      */
+      const xmlNode *node = 0;     //!< the subtree to parse
+      FoliaElement *tree = 0;      //!< the (partially) parsed subtree
+      FoliaElement *result = 0;    //!< the result of parsing the subtree
+      std::string create_error;    //!< the message when creating tree failed
+      std::exception_ptr error;    //!< the exception the parse threw
+      bool fallback = false;       //!< parse it sequentially after all
+      std::vector<std::string> ids; //!< the xml:id's found, in order
+      std::map<std::string,FoliaElement*> index; //!< lookup for those id's
+      std::map<AnnotationType,std::map<std::string,int>> refs; //!<
+      ///< the changes to the annotation reference counts
+      std::vector<FoliaElement*> deletions; //!< nodes kept for deletion
+      std::vector<External*> externals; //!< External nodes found
+      std::vector<TextContent*> t_offsets; //!< TextContent to validate
+      std::vector<PhonContent*> p_offsets; //!< PhonContent to validate
+      std::set<std::string> textclasses; //!< all textclasses seen
+      int warn_count = 0; //!< the number of warnings
+    };
+    static thread_local parse_job *_parse_job; ///< the job of this thread
+    void run_parse_job( parse_job& );
+    void discard_parse_job( parse_job& );
+    std::vector<parse_job> _parse_jobs; ///< the subtrees parsed in parallel
+    size_t _merged_jobs; ///< the number of _parse_jobs merged sofar
     void test_temporary_text_exception( const std::string& ) const;
     void adjustTextMode();
     std::map<AnnotationType,std::map<std::string,annotation_info> > _annotationdefaults;   ///< stores all declared annotations per AnnotationType
@@ -452,11 +588,45 @@ namespace folia {
     std::vector<PhonContent*> p_offset_validation_buffer; ///< we register all
     ///< PhonContent nodes here to quickly access them for offset checks
     ///< that check is performed directly after parsing
+    enum class doc_index : unsigned char { WORDS=1, SENTENCES=2, PARAGRAPHS=4,
+					   WORD_POSITIONS=8, SPANS=16 };
+    void check_index( doc_index ) const;
+    bool index_outdated( doc_index which ) const {
+      /// true when the list for \e which is built, but marked by a change
+      unsigned char bit = static_cast<unsigned char>(which);
+      return _index_built.load( std::memory_order_relaxed )
+	& _index_dirty.load( std::memory_order_relaxed )
+	& bit;
+    }
+    mutable std::mutex _index_mutex; ///< guards the cached lists below
+    mutable std::atomic<unsigned char> _index_dirty{0}; ///< the doc_index-es
+    ///< that are touched by a change in the tree since the last request.
+    ///< They are rebuilt on the next request
+    mutable std::atomic<unsigned char> _index_built{0}; ///< which doc_index-es
+    ///< are filled. Only changed while holding _index_mutex
+    mutable std::vector<Word*> _word_index; ///< all Words, in document order,
+    ///< as returned by words()
+    mutable std::unordered_map<const Word*,size_t> _word_positions; ///< the
+    ///< position of every Word in _word_index
+    mutable std::unordered_map<const FoliaElement*,
+			       std::vector<AbstractSpanAnnotation*>> _span_index; ///<
+    ///< for every referable node, all span annotations that refer to it,
+    ///< in document order
+    mutable std::vector<Sentence*> _sentence_index; ///< all Sentences, in
+    ///< document order, as returned by sentences()
+    mutable std::vector<Paragraph*> _paragraph_index; ///< all Paragraphs, in
+    ///< document order, as returned by paragraphs()
     void parse_imdi( const xmlNode * );
     void parse_annotations( const xmlNode * );
     void parse_provenance( const xmlNode * );
     void parse_submeta( const xmlNode * );
     void parse_styles();
+    void parse_style_pi( const std::string&, long int );
+    FoliaElement *parse_stream( xmlTextReader * );
+    bool read_from_reader( xmlTextReader * );
+    bool read_from_memory( const char *, size_t, const char * );
+    bool read_from_decompressor( Decompressor * );
+    bool parse_xmldoc();
     void add_annotations( xmlNode * ) const;
     void add_provenance( xmlNode * ) const;
     void add_metadata( xmlNode * ) const;
@@ -500,6 +670,16 @@ namespace folia {
     bool _incremental_parse;
     bool _preserve_spaces;
     mutable int _warn_count;
+    mutable unsigned int _parse_threads;
+    mutable std::map<std::thread::id,ElementArena*> _arenas; ///< per thread
+    mutable std::mutex _arena_mutex; ///< guards _arenas and _detached
+    mutable std::atomic<bool> _has_arenas; ///< set when _arenas is used
+    std::set<FoliaElement*> _detached; ///< arena nodes removed from
+    ///< the tree, but not destroyed
+    mutable std::atomic<bool> _has_text_caches;
+    mutable std::mutex _text_cache_mutex; ///< guards _text_caches
+    mutable text_cache_map _text_caches; ///< kept apart from the nodes, so
+    ///< filling it never changes a node that other threads may read
     Document( const Document& ) = delete; // inhibit copies
     Document& operator=( const Document& ) = delete; // inhibit copies
   };
@@ -514,6 +694,9 @@ namespace folia {
   inline bool Document::canonical() const { return mode % DocMode::CANONICAL; }
   inline bool Document::autodeclare() const { return mode % DocMode::AUTODECLARE; }
   inline bool Document::has_explicit() const { return mode % DocMode::EXPLICIT; }
+  inline bool Document::streaming() const { return mode % DocMode::STREAM; }
+  inline bool Document::arena() const { return mode % DocMode::ARENA; }
+  inline bool Document::cachetext() const { return mode % DocMode::CACHETEXT; }
 
   template <> inline
     Text *Document::create_root( const KWargs& args ){
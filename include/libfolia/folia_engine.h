@@ -113,6 +113,7 @@ namespace folia {
     std::string _out_name;  //!< the name of the output file connected to _os
     std::string ns_prefix;  //!< a namespace name to use. (copied from the input file)
     std::string _footer;    //!< the constructed string to output at the end
+    std::string _input_buffer; //!< decompressed input the _reader parses
     bool _ok;               //!< are we fine?
     bool _done;             //!< are we done parsing?
     bool _header_done;      //!< is the header outputed yet?
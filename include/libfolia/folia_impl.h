@@ -28,6 +28,9 @@
 #define FOLIA_IMPL_H
 
 #include <type_traits>
+#include <iterator>
+#include <bitset>
+#include <atomic>
 #include <set>
 #include <map>
 #include <vector>
@@ -81,6 +84,8 @@ namespace folia {
     TOP_HIT=2 //!< like recurse, but do NOT recurse into sibblings of matching nodes
   };
 
+  template <typename F> class select_range;
+
   /// class used to steer 'xml:space' behaviour
   enum class SPACE_FLAGS {
     UNSET=-1,  //!< not yet known
@@ -126,6 +131,8 @@ namespace folia {
       return tmp != nullptr;
     }
 
+    bool is_a( ElementType ) const;
+
     template <typename T>
       inline T *add_child( KWargs& args ){
       /// create a new FoliaElement of type T as child of this
@@ -188,13 +195,9 @@ namespace folia {
     std::vector<F*> select( const std::string& st,
 			    const std::set<ElementType>& exclude,
 			    SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
-      std::vector<FoliaElement*> tmp = select( F::PROPS.ELEMENT_ID,
-					       st,
-					       exclude,
-					       flag );
       std::vector<F*> res;
-      for ( size_t i = 0; i < tmp.size(); ++i ){
-	res.push_back( dynamic_cast<F*>( tmp[i]) );
+      for ( F *f : each<F>( st, exclude, flag ) ){
+	res.push_back( f );
       }
       return res;
     }
@@ -202,51 +205,62 @@ namespace folia {
     template <typename F>
     std::vector<F*> select( const std::string& st,
 			    SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
-      std::vector<FoliaElement*> tmp = select( F::PROPS.ELEMENT_ID,
-					       st,
-					       flag );
-      std::vector<F*> res;
-      for ( size_t i = 0; i < tmp.size(); ++i ){
-	res.push_back( dynamic_cast<F*>( tmp[i]) );
-      }
-      return res;
+      return select<F>( st, default_ignore, flag );
     }
 
     template <typename F>
     std::vector<F*> select( const char *st,
 			    SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
-      std::vector<FoliaElement*> tmp = select( F::PROPS.ELEMENT_ID,
-					       std::string(st),
-					       flag );
-      std::vector<F*> res;
-      for ( size_t i = 0; i < tmp.size(); ++i ){
-	res.push_back( dynamic_cast<F*>( tmp[i]) );
-      }
-      return res;
+      return select<F>( std::string(st), default_ignore, flag );
     }
 
     template <typename F>
     std::vector<F*> select( const std::set<ElementType>& exclude,
 			    SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
-      std::vector<FoliaElement*> tmp = select( F::PROPS.ELEMENT_ID,
-					       exclude,
-					       flag );
-      std::vector<F*> res;
-      for ( size_t i = 0; i < tmp.size(); ++i ){
-	res.push_back( dynamic_cast<F*>( tmp[i]) );
-      }
-      return res;
+      return select<F>( "", exclude, flag );
     }
 
     template <typename F>
     std::vector<F*> select( SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
-      std::vector<FoliaElement*> tmp = select( F::PROPS.ELEMENT_ID,
-					       flag  );
-      std::vector<F*> res;
-      for ( size_t i = 0; i < tmp.size(); ++i ){
-	res.push_back( dynamic_cast<F*>( tmp[i]) );
-      }
-      return res;
+      return select<F>( "", default_ignore, flag );
+    }
+
+    // lazy selections. These visit the same nodes as select<F>(), in the
+    // same order, without collecting them first
+
+    template <typename F>
+    select_range<F> each( const std::string& st,
+			  const std::set<ElementType>& exclude,
+			  SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const;
+
+    template <typename F>
+    select_range<F> each( const std::set<ElementType>& exclude,
+			  SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
+      return each<F>( "", exclude, flag );
+    }
+
+    template <typename F>
+    select_range<F> each( SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
+      return each<F>( "", default_ignore, flag );
+    }
+
+    template <typename F, typename Fn>
+    bool for_each( Fn fn,
+		   const std::string& st,
+		   const std::set<ElementType>& exclude,
+		   SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const;
+
+    template <typename F, typename Fn>
+    bool for_each( Fn fn,
+		   const std::set<ElementType>& exclude,
+		   SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
+      return for_each<F>( fn, "", exclude, flag );
+    }
+
+    template <typename F, typename Fn>
+    bool for_each( Fn fn,
+		   SELECT_FLAGS flag = SELECT_FLAGS::RECURSE ) const {
+      return for_each<F>( fn, "", default_ignore, flag );
     }
 
     // annotations
@@ -342,6 +356,7 @@ namespace folia {
 
     const std::string str( const std::string& = "current" ) const;
     const std::string str( const TextPolicy& ) const;
+    void text_utf8( const TextPolicy&, std::string& ) const;
 
     virtual const UnicodeString unicode( const std::string& = "current" ) const = 0;
     virtual const UnicodeString unicode( const TextPolicy& ) const = 0;
@@ -565,6 +580,7 @@ namespace folia {
     virtual void increfcount() = 0;
     virtual void decrefcount() = 0;
     virtual void resetrefcount() = 0;
+    virtual void clear_text_cache() = 0;
     virtual void setAttributes( KWargs& ) = 0;
     virtual void set_processor_name( const std::string& ) = 0;
     virtual void annotator2processor( const std::string&,
@@ -577,13 +593,142 @@ namespace folia {
     virtual const std::string generateId( const std::string& ) NOT_IMPLEMENTED;
     virtual const std::string& textclass() const NOT_IMPLEMENTED;
     virtual void unravel( std::set<FoliaElement*>& ) NOT_IMPLEMENTED;
+    virtual void gather( std::vector<FoliaElement*>& ) NOT_IMPLEMENTED;
+    virtual void release() NOT_IMPLEMENTED;
+    virtual void disown() NOT_IMPLEMENTED;
     static FoliaElement *private_createElement( ElementType );
   public:
+    static void *operator new( size_t );
+    static void operator delete( void * );
     static FoliaElement *createElement( ElementType, Document * =0 );
     static FoliaElement *createElement( const std::string&, Document * =0 );
 
   }; // class FoliaElement
 
+  /// the engine behind select() and each(): a depth first walk over all
+  /// nodes below a root which have a given ElementType (and set)
+  /*!
+    The walk visits the nodes in document order, just like select(), but
+    returns them one at a time. It stops descending where the exclude set
+    says so, and where contained_types() tells that no match can be found.
+    The tree may not be modified during the walk.
+  */
+  class select_walker {
+  public:
+    select_walker( const FoliaElement *,
+		   ElementType,
+		   const std::string&,
+		   const std::set<ElementType>&,
+		   SELECT_FLAGS );
+    select_walker( const select_walker& ) = delete;
+    select_walker& operator=( const select_walker& ) = delete;
+    FoliaElement *next();
+  private:
+    struct level {
+      const std::vector<FoliaElement*> *data;
+      size_t pos;
+      SELECT_FLAGS flag;
+    };
+    std::vector<level> _stack;
+    std::bitset<ELEMENT_TYPE_COUNT> _exclude;
+    ElementType _type;
+    const std::string *_set_key;
+  };
+
+  template <typename F>
+  inline F *element_cast( FoliaElement *el ){
+    /// cast el to an F, when it is known that the ElementType of el is that
+    /// of F
+    /*!
+      No FoLiA class derives from another concrete class, so an F is the
+      most derived object. That avoids the full dynamic_cast<F*>, which has
+      to search the class hierarchy.
+    */
+    return static_cast<F*>( dynamic_cast<void*>( el ) );
+  }
+
+  /// a lazy range over all F nodes below a FoliaElement. See each()
+  template <typename F>
+  class select_range {
+  public:
+    class iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = F*;
+      using difference_type = std::ptrdiff_t;
+      using pointer = F**;
+      using reference = F*;
+      iterator(): _walker(0), _current(0) {};
+      explicit iterator( select_walker *w ): _walker(w), _current(w->next()) {};
+      F *operator*() const { return element_cast<F>( _current ); };
+      iterator& operator++(){ _current = _walker->next(); return *this; };
+      bool operator==( const iterator& other ) const {
+	return _current == other._current;
+      };
+      bool operator!=( const iterator& other ) const {
+	return _current != other._current;
+      };
+    private:
+      select_walker *_walker;
+      FoliaElement *_current;
+    };
+    select_range( const FoliaElement *root,
+		  const std::string& st,
+		  const std::set<ElementType>& exclude,
+		  SELECT_FLAGS flag ):
+      _walker( root, F::PROPS.ELEMENT_ID, st, exclude, flag ) {};
+    iterator begin() { return iterator( &_walker ); };
+    iterator end() { return iterator(); };
+  private:
+    select_walker _walker;
+  };
+
+  template <typename F>
+  select_range<F> FoliaElement::each( const std::string& st,
+				      const std::set<ElementType>& exclude,
+				      SELECT_FLAGS flag ) const {
+    /// return a lazy range over the nodes that select<F>() would return
+    /*!
+      \param st when not empty ("") we also must match on the 'sett' of the nodes
+      \param exclude a set of ElementType to exclude from searching.
+      \param flag the search strategy, see AbstractElement::select()
+
+      example:
+      \code
+      for ( Word *w : doc.doc()->each<Word>() ){ ... }
+      \endcode
+    */
+    return select_range<F>( this, st, exclude, flag );
+  }
+
+  template <typename F, typename Fn>
+  bool FoliaElement::for_each( Fn fn,
+			       const std::string& st,
+			       const std::set<ElementType>& exclude,
+			       SELECT_FLAGS flag ) const {
+    /// call fn for every node that select<F>() would return
+    /*!
+      \param fn a function taking an F*. When it returns a bool, false
+      stops the walk.
+      \param st when not empty ("") we also must match on the 'sett' of the nodes
+      \param exclude a set of ElementType to exclude from searching.
+      \param flag the search strategy, see AbstractElement::select()
+      \return false when fn stopped the walk, true otherwise
+    */
+    select_walker walker( this, F::PROPS.ELEMENT_ID, st, exclude, flag );
+    while ( FoliaElement *el = walker.next() ){
+      if constexpr ( std::is_void_v<std::invoke_result_t<Fn&,F*>> ){
+	fn( element_cast<F>( el ) );
+      }
+      else {
+	if ( !fn( element_cast<F>( el ) ) ){
+	  return false;
+	}
+      }
+    }
+    return true;
+  }
+
   class AbstractElement: public virtual FoliaElement {
     friend void destroy( FoliaElement * );
   private:
@@ -597,6 +742,18 @@ namespace folia {
   public:
     void destroy() override;
     void classInit( const KWargs& );
+    /// RAII helper to remember the text() results of the current thread
+    /// while parsing, so the text consistency checks of a node reuse the
+    /// results of its (already checked) children
+    class parse_scope {
+    public:
+      parse_scope();
+      ~parse_scope();
+      parse_scope( const parse_scope& ) = delete;
+      parse_scope& operator=( const parse_scope& ) = delete;
+    private:
+      bool _owner;
+    };
 
     //functions regarding contained data
     size_t size() const override { return _data.size(); };
@@ -708,24 +865,24 @@ namespace folia {
     const std::string& sett() const override { return _set; };
     void set_set( const std::string& st ) override { _set = st; };
 
-    const std::string& tag() const override { return _tags; };
+    const std::string& tag() const override;
     const std::string set_tag( const std::string&  ) override;
     const std::string settag( const std::string& t ){
       return set_tag(t); };                              //deprecated
 
-    const std::string& n() const override { return _n; };
-    void set_n( const std::string& n ) override { _n = n; };
+    const std::string& n() const override;
+    void set_n( const std::string& ) override;
 
     const std::string& id() const override { return _id; };
 
     long int line_number() const override { return _line_no; };
     void set_line_number( long int _num ) override { _line_no = _num; };
 
-    const std::string& begintime() const override { return _begintime; };
-    void set_begintime( const std::string& bt ) override { _begintime = bt; };
+    const std::string& begintime() const override;
+    void set_begintime( const std::string& ) override;
 
-    const std::string& endtime() const override { return _endtime; };
-    void set_endtime( const std::string& bt ) override { _endtime = bt; };
+    const std::string& endtime() const override;
+    void set_endtime( const std::string& ) override;
 
     const std::string& textclass() const override { return _textclass; };
     void textclass( const std::string& tc ) { _textclass = tc; };
@@ -742,12 +899,12 @@ namespace folia {
     SPACE_FLAGS spaces_flag() const override { return _preserve_spaces; };
     void set_spaces_flag( SPACE_FLAGS f ) override { _preserve_spaces = f; };
 
-    double confidence() const override { return _confidence; };
-    void confidence( double d ) override { _confidence = d; };
-    void set_confidence( double d ) override { _confidence = d; };
+    double confidence() const override;
+    void confidence( double d ) override { set_confidence( d ); };
+    void set_confidence( double ) override;
 
     const std::string language( const std::string& = "" ) const override;
-    const std::string& src() const override { return _src; };
+    const std::string& src() const override;
     // generic properties
     const ElementType& element_id() const override;
     const size_t& occurrences() const override;
@@ -793,6 +950,9 @@ namespace folia {
 					   SELECT_FLAGS = SELECT_FLAGS::RECURSE ) const override;
 
     void unravel( std::set<FoliaElement*>& ) override;
+    void gather( std::vector<FoliaElement*>& ) override;
+    void release() override;
+    void disown() override;
 
   protected:
     xmlNode *xml( bool, bool = false ) const override;
@@ -805,11 +965,14 @@ namespace folia {
     xmlNs *foliaNs() const;
     bool addable( const FoliaElement * ) const override;
     const properties& props() const { return _props; };
+    void tree_changed( const FoliaElement * );
+    static void mark_text_uncachable();
   private:
     int refcount() const override { return _refcount; };
     void increfcount() override { ++_refcount; };
     void decrefcount() override { --_refcount; };
     void resetrefcount() override { _refcount = 0; };
+    void clear_text_cache() override;
     void setAuth( bool b ) override { _auth = b; };
     void setDateTime( const std::string& ) override;
     const std::string getDateTime() const override;
@@ -817,36 +980,38 @@ namespace folia {
     void set_typegroup( KWargs& ) const;
     bool acceptable( ElementType ) const override;
     UnicodeString text_container_text( const TextPolicy& ) const override;
+    const UnicodeString cached_text( const TextPolicy& ) const;
+    const UnicodeString memo_text( const TextPolicy& ) const;
+    static thread_local unsigned int _uncachable_texts;
+    struct text_memo;
+    static thread_local text_memo *_parse_texts;
     void check_text_consistency(bool = true) const override;
     void check_text_consistency_while_parsing( bool = true,
 					       bool = false ) override; //can't we merge these two somehow?
     void check_append_text_consistency( const FoliaElement * ) const override;
     void check_set_declaration();
+    void parse_children( const xmlNode *, bool );
     void addFeatureNodes( const KWargs& args );
     void dbg( const std::string& ) const;
+    void free_memory();
+    struct rare_attributes;
+    rare_attributes& rare();
     Document *_mydoc;
     FoliaElement *_parent;
     bool _auth;
     bool _space;
     AnnotatorType _annotator_type;
     int _refcount;
+    SPACE_FLAGS _preserve_spaces;
     long int _line_no;
-    double _confidence;
-    std::string _annotator;
-    std::string _n;
+    rare_attributes *_rare; ///< the seldom used attributes, 0 when all unset
+    interned_string _annotator;
     std::string _datetime;
-    std::string _begintime;
-    std::string _endtime;
-    std::string _speaker;
     std::string _textclass;
-    std::string _metadata;
-    std::string _processor_id;
-    std::string _set;
-    std::string _class;
+    interned_string _processor_id;
+    interned_string _set;
+    interned_string _class;
     std::string _id;
-    std::string _src;
-    std::string _tags;
-    SPACE_FLAGS _preserve_spaces;
     std::vector<FoliaElement*> _data;
     const properties& _props;
   }; // class AbstractElement
@@ -1011,6 +1176,7 @@ namespace folia {
 
   UnicodeString trim_space( const UnicodeString& in );
   UnicodeString postprocess_spaces( const UnicodeString& in );
+  UnicodeString dumb_spaces( const UnicodeString& );
   std::string tagToAtt( const FoliaElement* );
   void destroy( FoliaElement *el );
   ElementType get_abstract_parent( const ElementType et );
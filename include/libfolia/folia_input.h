@@ -0,0 +1,94 @@
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of libfolia
+
+  libfolia is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  libfolia is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/ticcutils/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+*/
+
+#ifndef FOLIA_INPUT_H
+#define FOLIA_INPUT_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <functional>
+#include "libxml/tree.h"
+#include "libxml/xmlreader.h"
+
+namespace folia {
+
+  /// the compression formats we can recognize by their magic bytes
+  enum class Compression {
+    NONE,  //!< not compressed (or unrecognized)
+    GZIP,  //!< gzip (.gz)
+    BZIP2, //!< bzip2 (.bz2)
+    XZ,    //!< xz/lzma (.xz)
+    ZSTD   //!< Zstandard (.zst)
+  };
+
+  std::string toString( const Compression );
+  Compression detect_compression( const unsigned char *, size_t );
+  Compression detect_compression( const std::string& );
+
+  /// abstract base class for streaming decompressors
+  /*!
+    A Decompressor reads compressed data from a file in fixed size chunks
+    and hands out decompressed data on request, so the complete inflated
+    input is never held in memory.
+    Derived classes implement read(), using fill() to get more input.
+  */
+  class Decompressor {
+  public:
+    explicit Decompressor( const std::string& );
+    virtual ~Decompressor();
+    Decompressor( const Decompressor& ) = delete;
+    Decompressor& operator=( const Decompressor& ) = delete;
+    /// decompress at most len bytes into buffer
+    /*!
+      \return the number of bytes stored, 0 at the end of the input.
+      Throws a DocumentError on corrupt or truncated input, and on trailing
+      garbage after the compressed data.
+    */
+    virtual int read( char *buffer, int len ) = 0;
+    const std::string& file_name() const { return _file_name; };
+  protected:
+    size_t fill();
+    [[noreturn]] void fail( const std::string& ) const;
+    std::string _file_name;           //!< the file we read from
+    std::FILE *_file;                 //!< the open file
+    std::vector<unsigned char> _in;   //!< the buffer with compressed input
+  };
+
+  /// a function creating a Decompressor on a file
+  using DecompressorFactory
+  = std::function<Decompressor*( const std::string& )>;
+
+  void register_decompressor( const Compression, const DecompressorFactory& );
+  bool has_decompressor( const Compression );
+  Decompressor *create_decompressor( const std::string&, const Compression );
+  xmlTextReader *decompress_reader( Decompressor * );
+  xmlDoc *decompress_xmldoc( Decompressor * );
+  void check_decompress_error();
+
+} // namespace folia
+
+#endif // FOLIA_INPUT_H
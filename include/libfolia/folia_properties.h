@@ -28,10 +28,12 @@
 #define PROPERTIES_H
 
 #include <set>
+#include <array>
+#include <bitset>
 #include <string>
+#include "libfolia/folia_types.h"
 
 namespace folia {
-  enum class ElementType : unsigned int;
   enum class Attrib : int;
   enum class AnnotatorType: int;
   enum class AnnotationType : int;
@@ -43,6 +45,8 @@ namespace folia {
     std::string XMLTAG;
     std::set<ElementType> ACCEPTED_DATA;
     std::set<ElementType> REQUIRED_DATA;
+    // ACCEPTED_DATA, extended with all subtypes. Set up by static_init()
+    std::bitset<ELEMENT_TYPE_COUNT> ACCEPTED_BITS;
     Attrib REQUIRED_ATTRIBS;
     Attrib OPTIONAL_ATTRIBS;
     AnnotationType ANNOTATIONTYPE;
@@ -78,7 +82,20 @@ namespace folia {
   extern const std::map<AnnotationType,std::string> annotationtype_xml_map;
   extern const std::map<std::string,std::string> oldtags;
   extern std::map<std::string,std::string> reverse_old;
-  extern std::map<ElementType,properties*> element_props;
+  /// the properties of every ElementType, indexed by that ElementType
+  class element_properties {
+  public:
+    properties*& operator[]( ElementType et ){
+      return _props[static_cast<std::size_t>(et)];
+    }
+    properties *operator[]( ElementType et ) const {
+      return _props[static_cast<std::size_t>(et)];
+    }
+  private:
+    std::array<properties*,ELEMENT_TYPE_COUNT> _props = {};
+  };
+
+  extern element_properties element_props;
   extern std::map<ElementType,ElementType> abstract_parents;
   extern const std::set<ElementType> default_ignore;
   extern const std::set<ElementType> default_ignore_annotations;
@@ -98,6 +115,7 @@ namespace folia {
   extern std::string host_name;
 
   bool is_subtype( const ElementType&, const ElementType& );
+  const std::bitset<ELEMENT_TYPE_COUNT>& contained_types( ElementType );
   bool isAttributeFeature( const std::string& );
   void static_init();
   void print_type_hierarchy( std::ostream& );
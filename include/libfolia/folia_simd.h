@@ -0,0 +1,54 @@
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of libfolia
+
+  libfolia is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  libfolia is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/ticcutils/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+*/
+
+#ifndef FOLIA_SIMD_H
+#define FOLIA_SIMD_H
+
+#include <cstddef>
+#include <string>
+#include "unicode/umachine.h"
+
+namespace folia {
+
+  /// the instruction sets the whitespace scans can use
+  /*!
+    The scans behind normalize_spaces(), dumb_spaces() and
+    postprocess_spaces() have SSE2 and AVX2 versions on x86, next to a
+    plain C++ one. The best one the CPU supports is picked at startup.
+  */
+  enum class SIMD_LEVEL { SCALAR, SSE2, AVX2 };
+
+  SIMD_LEVEL simd_support();
+  SIMD_LEVEL simd_level();
+  SIMD_LEVEL set_simd_level( SIMD_LEVEL );
+  std::string toString( SIMD_LEVEL );
+
+  size_t skip_ascii_range( const UChar *, size_t, size_t, UChar, UChar );
+  size_t skip_plain_ascii( const UChar *, size_t, size_t );
+
+} // namespace folia
+
+#endif // FOLIA_SIMD_H
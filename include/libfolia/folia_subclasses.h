@@ -129,9 +129,18 @@ public:							\
   public:
     xmlNode *xml( bool, bool=false ) const override;
     FoliaElement *append( FoliaElement* ) override;
+    void remove( FoliaElement * ) override;
+    FoliaElement* replace( FoliaElement *, FoliaElement* ) override;
+    void insert_after( FoliaElement *, FoliaElement * ) override;
 
     std::vector<FoliaElement*> wrefs() const override;
     FoliaElement *wrefs( size_t ) const override;
+    const std::vector<FoliaElement*>& wrefs_view() const;
+  private:
+    void invalidate_wrefs();
+    mutable std::vector<FoliaElement*> _wrefs; ///< the cached result of
+    ///< wrefs(), valid when _wrefs_valid is set
+    mutable std::atomic<bool> _wrefs_valid{false};
   };
 
   class SpanRelation: public AbstractElement {
@@ -667,7 +676,6 @@ public:							\
   };
 
   class WordReference: public AbstractWord {
-    friend std::vector<FoliaElement*> AbstractSpanAnnotation::wrefs() const;
   public:
     ADD_DEFAULT_CONSTRUCTORS( WordReference, AbstractWord );
     std::string tval() const { return _tval; };
@@ -680,9 +688,7 @@ public:							\
   private:
     FoliaElement *parseXml( const xmlNode *node ) override;
     xmlNode *xml( bool, bool=false ) const override;
-    const UnicodeString private_text( const TextPolicy& tp ) const override {
-      return _reference->private_text( tp );
-    }
+    const UnicodeString private_text( const TextPolicy& tp ) const override;
     const std::string& get_delimiter( const TextPolicy& tp ) const override {
       return _reference->get_delimiter( tp );
     }
@@ -949,6 +955,8 @@ public:							\
     xmlNode *xml( bool, bool=false ) const override;
     void setvalue( const std::string& );
     void setuvalue( const UnicodeString& );
+    /// the (UTF8) value, as text() would return it when no policy applies
+    const std::string& value() const { return _value; };
     const std::string& get_delimiter( const TextPolicy& ) const override {
       return EMPTY_STRING; };
     void setAttributes( KWargs& ) override;
@@ -74,11 +74,13 @@ namespace folia {
     using tag_handler = std::function<icu::UnicodeString(const FoliaElement*,
 							 const TextPolicy& )>;
     bool is_set( TEXT_FLAGS ) const;
+    TEXT_FLAGS get_flags() const { return _text_flags; };
     void set( TEXT_FLAGS );
     void clear( TEXT_FLAGS );
     void add_handler( const std::string&, const tag_handler& );
     const tag_handler remove_handler( const std::string& );
     const tag_handler get_handler( const std::string& ) const;
+    bool has_handlers() const { return !_tag_handlers.empty(); };
     const std::string& get_class() const { return _class; };
     void set_class( const std::string& c ) { _class = c; };
     CORRECTION_HANDLING get_correction_handling() const {
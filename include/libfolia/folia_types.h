@@ -27,6 +27,7 @@
 #ifndef TYPES_H
 #define TYPES_H
 #include <string>
+#include <string_view>
 #include "ticcutils/StringOps.h"
 #include "ticcutils/enum_flags.h"
 
@@ -35,6 +36,10 @@ namespace folia {
   //foliaspec:elementtype
   enum class ElementType : unsigned int { BASE=0, AbstractFeature_t, AbstractWord_t, AbstractAnnotationLayer_t, AbstractContentAnnotation_t, AbstractCorrectionChild_t, AbstractHigherOrderAnnotation_t, AbstractInlineAnnotation_t, AbstractSpanAnnotation_t, AbstractSpanRole_t, AbstractStructureElement_t, AbstractSubtokenAnnotation_t, AbstractTextMarkup_t, ActorFeature_t, Alternative_t, AlternativeLayers_t, BegindatetimeFeature_t, Caption_t, Cell_t, Chunk_t, ChunkingLayer_t, Comment_t, Content_t, CoreferenceChain_t, CoreferenceLayer_t, CoreferenceLink_t, Correction_t, Cue_t, Current_t, Definition_t, DependenciesLayer_t, Dependency_t, DependencyDependent_t, Description_t, Division_t, DomainAnnotation_t, EnddatetimeFeature_t, EntitiesLayer_t, Entity_t, Entry_t, ErrorDetection_t, EtymologyAnnotation_t, Event_t, Example_t, External_t, Feature_t, Figure_t, FontFeature_t, ForeignData_t, FunctionFeature_t, Gap_t, Head_t, HeadFeature_t, Headspan_t, Hiddenword_t, Hyphbreak_t, Label_t, LangAnnotation_t, LemmaAnnotation_t, LevelFeature_t, Linebreak_t, LinkReference_t, List_t, ListItem_t, Metric_t, ModalitiesLayer_t, Modality_t, ModalityFeature_t, Morpheme_t, MorphologyLayer_t, New_t, Note_t, Observation_t, ObservationLayer_t, Original_t, Paragraph_t, Part_t, PhonContent_t, Phoneme_t, PhonologyLayer_t, PolarityFeature_t, PosAnnotation_t, Predicate_t, Quote_t, Reference_t, Relation_t, Row_t, Scope_t, SemanticRole_t, SemanticRolesLayer_t, SenseAnnotation_t, Sentence_t, Sentiment_t, SentimentLayer_t, SizeFeature_t, Source_t, SpanRelation_t, SpanRelationLayer_t, Speech_t, Statement_t, StatementLayer_t, StatementRelation_t, StrengthFeature_t, String_t, StyleFeature_t, SubjectivityAnnotation_t, Suggestion_t, SynsetFeature_t, SyntacticUnit_t, SyntaxLayer_t, Table_t, TableHead_t, Target_t, Term_t, Text_t, TextContent_t, TextMarkupCorrection_t, TextMarkupError_t, TextMarkupGap_t, TextMarkupHSpace_t, TextMarkupLanguage_t, TextMarkupReference_t, TextMarkupString_t, TextMarkupStyle_t, TextMarkupWhitespace_t, TimeFeature_t, TimeSegment_t, TimingLayer_t, Utterance_t, ValueFeature_t, Whitespace_t, Word_t, WordReference_t, ProcessingInstruction_t, XmlComment_t, XmlText_t,  LastElement };
 
+  /// the number of ElementType values, for tables indexed by ElementType
+  const std::size_t ELEMENT_TYPE_COUNT
+    = static_cast<std::size_t>(ElementType::LastElement);
+
   inline ElementType& operator++( ElementType &et ){
     return et = ( ElementType::LastElement == et )
       ? ElementType::BASE
@@ -169,6 +174,10 @@ LAST_ANN };
 
   std::string toString( const ElementType& );
   ElementType stringToElementType( const std::string& );
+  ElementType stringToElementType( std::string_view );
+  inline ElementType stringToElementType( const char *tag ){
+    return stringToElementType( std::string_view( tag ) );
+  }
 
   ElementType layertypeof( ElementType );
 
@@ -28,10 +28,16 @@
 #define FOLIA_UTILS_H
 
 #include <map>
+#include <unordered_map>
 #include <set>
+#include <vector>
+#include <array>
+#include <forward_list>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <exception>
+#include <atomic>
 #include <ctime>
 #include "unicode/unistr.h"
 #include <unicode/ustream.h>
@@ -170,6 +176,121 @@ namespace folia {
 			  + message ){};
   };
 
+  ///
+  /// interned_string is a handle to a string in a global string pool
+  ///
+  /// Equal values share one pooled copy, so a handle is one pointer wide
+  /// and comparing two handles is a pointer comparison.
+  /// The pool is thread-safe. Pooled values are reference counted and
+  /// removed again when the last handle goes away, so the pool only holds
+  /// the values in use. It is meant for the small vocabularies of sets,
+  /// classes, processors etc.
+  ///
+  class interned_string {
+  public:
+    interned_string(): _entry( &empty_entry ){};
+    interned_string( const std::string& s ): _entry( intern( s ) ){};
+    interned_string( const char *s ): _entry( intern( s ) ){};
+    interned_string( const interned_string& other ): _entry( other._entry ){
+      acquire( _entry );
+    };
+    interned_string( interned_string&& other ) noexcept:
+      _entry( other._entry ){
+      other._entry = &empty_entry;
+    };
+    ~interned_string(){ release( _entry ); };
+    interned_string& operator=( const interned_string& other ){
+      acquire( other._entry );
+      release( _entry );
+      _entry = other._entry;
+      return *this;
+    };
+    interned_string& operator=( interned_string&& other ) noexcept {
+      std::swap( _entry, other._entry );
+      return *this;
+    };
+    interned_string& operator=( const std::string& s ){
+      const entry *e = intern( s );
+      release( _entry );
+      _entry = e;
+      return *this;
+    };
+    interned_string& operator=( const char *s ){
+      return operator=( std::string( s ) );
+    };
+    operator const std::string&() const { return _entry->value; };
+    const std::string& str() const { return _entry->value; };
+    const char *c_str() const { return _entry->value.c_str(); };
+    size_t size() const { return _entry->value.size(); };
+    bool empty() const { return _entry->value.empty(); };
+    void clear() {
+      release( _entry );
+      _entry = &empty_entry;
+    };
+    bool operator==( const interned_string& other ) const {
+      return _entry == other._entry;
+    };
+    bool operator!=( const interned_string& other ) const {
+      return _entry != other._entry;
+    };
+    static const std::string *lookup( const std::string& );
+    static size_t pool_size();
+  private:
+    /// a pooled value with the number of handles to it
+    struct entry {
+      explicit entry( const std::string& s ): value( s ), refs( 1 ){};
+      const std::string value;
+      mutable std::atomic<size_t> refs;
+    };
+    static std::unordered_map<std::string_view,const entry*>& string_pool();
+    static const entry *intern( const std::string& );
+    static void acquire( const entry *e ){
+      if ( e != &empty_entry ){
+	e->refs.fetch_add( 1, std::memory_order_relaxed );
+      }
+    };
+    static void release( const entry * );
+    const entry *_entry;
+    static const entry empty_entry;
+  };
+
+  inline bool operator==( const interned_string& is, const std::string& s ){
+    return is.str() == s;
+  }
+  inline bool operator==( const std::string& s, const interned_string& is ){
+    return is.str() == s;
+  }
+  inline bool operator==( const interned_string& is, const char *s ){
+    return is.str() == s;
+  }
+  inline bool operator!=( const interned_string& is, const std::string& s ){
+    return is.str() != s;
+  }
+  inline bool operator!=( const std::string& s, const interned_string& is ){
+    return is.str() != s;
+  }
+  inline bool operator!=( const interned_string& is, const char *s ){
+    return is.str() != s;
+  }
+  inline std::string operator+( const std::string& s,
+				const interned_string& is ){
+    return s + is.str();
+  }
+  inline std::string operator+( const interned_string& is,
+				const std::string& s ){
+    return is.str() + s;
+  }
+  inline std::string operator+( const char *s, const interned_string& is ){
+    return s + is.str();
+  }
+  inline std::string operator+( const interned_string& is, const char *s ){
+    return is.str() + s;
+  }
+  inline std::ostream& operator<<( std::ostream& os,
+				   const interned_string& is ){
+    return os << is.str();
+  }
+
   ///
   /// KWargs is a class to hold attribute/value entries,
   ///
@@ -194,8 +315,42 @@ namespace folia {
   KWargs getArgs( const std::string& );
   std::string toString( const KWargs& );
 
+  ///
+  /// attribute_bag holds the attributes of one xmlNode during parsing.
+  /// For internal use.
+  ///
+  /// The attributes and values are string_views into the libxml2 tree, so
+  /// a bag is only valid as long as that node exists. The first few pairs
+  /// are stored in the bag itself, so most nodes need no allocations at all.
+  /// Use to_kwargs() to make a real KWargs.
+  ///
+  class attribute_bag {
+  public:
+    using value_type = std::pair<std::string_view,std::string_view>;
+    attribute_bag(): _size( 0 ){};
+    bool add( std::string_view, std::string_view );
+    std::string_view keep( std::string&& );
+    std::string_view lookup( std::string_view ) const;
+    KWargs to_kwargs() const;
+    const value_type *begin() const { return data(); };
+    const value_type *end() const { return data() + _size; };
+    size_t size() const { return _size; };
+    bool empty() const { return _size == 0; };
+  private:
+    static const size_t INLINE_SIZE = 8;
+    const value_type *data() const {
+      return _size > INLINE_SIZE ? _spill.data() : _inline.data(); };
+    std::array<value_type,INLINE_SIZE> _inline;
+    std::vector<value_type> _spill; ///< used when _inline is full
+    size_t _size;
+    std::forward_list<std::string> _kept; ///< strings not in the xml tree
+    attribute_bag( const attribute_bag& ) = delete; // inhibit copies
+    attribute_bag& operator=( const attribute_bag& ) = delete; // inhibit copies
+  };
+
   void addAttributes( xmlNode *, const KWargs&, bool=false );
   KWargs getAttributes( const xmlNode * );
+  void getAttributes( const xmlNode *, attribute_bag& );
 
   std::string parseDate( const std::string& );
   std::string parseTime( const std::string& );
@@ -209,6 +364,7 @@ namespace folia {
   bool document_sanity_check();
   bool space_sanity_check();
   bool subclass_sanity_check();
+  bool sizeof_sanity_check();
 
   ///
   /// some xml goodies
@@ -225,6 +381,11 @@ namespace folia {
     return std::string( reinterpret_cast<const char *>(in), size );
   }
 
+  inline std::string_view to_string_view( const xmlChar *in ){
+    return in ? std::string_view( reinterpret_cast<const char *>(in) )
+      : std::string_view();
+  }
+
   using TiCC::TextValue;
   using TiCC::isNCName;
 
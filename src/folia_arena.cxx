@@ -0,0 +1,176 @@
+
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of libfolia
+
+  libfolia is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  libfolia is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/ticcutils/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+*/
+
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include "libfolia/folia_arena.h"
+
+using namespace std;
+
+namespace folia {
+
+  /// slots are aligned like ::operator new would do
+  const size_t SLOT_ALIGN = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  thread_local ElementArena *ElementArena::_current = 0;
+
+  /// the arenas of a deleted Document that still hold detached nodes
+  struct orphan_group {
+    vector<ElementArena*> arenas;
+    size_t pins; ///< the number of nodes still alive in the arenas
+  };
+
+  /// all orphan_groups. Normally empty, so unpin() returns at once
+  static mutex orphan_lock;
+  static vector<orphan_group> orphans;
+  static atomic<size_t> orphan_count( 0 );
+
+  ElementArena::ElementArena( const void *owner, mutex& lock,
+			      size_t block_size ):
+    /// create an empty arena
+    /*!
+      \param owner the object (normally a Document) owning this arena
+      \param lock the lock of the owner, taken when a block is added
+      \param block_size the size of the memory blocks to reserve at once
+    */
+    _owner( owner ),
+    _lock( lock ),
+    _block_size( block_size ),
+    _next( 0 ),
+    _end( 0 ),
+    _live( 0 ),
+    _reserved( 0 )
+  {
+  }
+
+  ElementArena::~ElementArena(){
+    /// release all memory blocks in one go
+    /*!
+      No destructors are run for the slots still in use.
+    */
+    for ( const auto& block : _blocks ){
+      ::operator delete( block.first );
+    }
+  }
+
+  void *ElementArena::allocate( size_t size ){
+    /// get a slot of at least \e size bytes
+    /*!
+      \param size the number of bytes needed
+      \return a pointer to the slot, aligned like ::operator new would do
+      The slot is taken from the current block, reserving a new block when
+      needed.
+    */
+    size_t slot_size = ( size + SLOT_ALIGN - 1 ) / SLOT_ALIGN * SLOT_ALIGN;
+    if ( _next == 0
+	 || static_cast<size_t>( _end - _next ) < slot_size ){
+      size_t block_size = max( _block_size, slot_size );
+      char *block = static_cast<char*>( ::operator new( block_size ) );
+      {
+	lock_guard<mutex> guard( _lock );
+	auto it = upper_bound( _blocks.begin(), _blocks.end(),
+			       make_pair( block, block + block_size ) );
+	_blocks.insert( it, make_pair( block, block + block_size ) );
+      }
+      _next = block;
+      _end = block + block_size;
+      _reserved += block_size;
+    }
+    char *slot = _next;
+    _next += slot_size;
+    ++_live;
+    return slot;
+  }
+
+  bool ElementArena::owns( const void *p ) const {
+    /// check if \e p points into one of the blocks of this arena
+    /*!
+      A binary search over the blocks. Other threads than the one using
+      the arena must hold the lock of the owner.
+    */
+    const char *slot = static_cast<const char*>( p );
+    auto it = upper_bound( _blocks.begin(), _blocks.end(), slot,
+			   []( const char *s, const pair<char*,char*>& b ){
+			     return s < b.first; } );
+    if ( it == _blocks.begin() ){
+      return false;
+    }
+    --it;
+    return slot < it->second;
+  }
+
+  void ElementArena::orphan( const vector<ElementArena*>& arenas,
+			     size_t pins ){
+    /// keep the arenas of a deleted owner, until \e pins nodes are freed
+    /*!
+      \param arenas the arenas to keep. They are deleted when the last
+      pinned node is given back using unpin()
+      \param pins the number of nodes still in use
+    */
+    if ( pins == 0 ){
+      for ( const auto& a : arenas ){
+	delete a;
+      }
+      return;
+    }
+    lock_guard<mutex> guard( orphan_lock );
+    orphans.push_back( { arenas, pins } );
+    ++orphan_count;
+  }
+
+  bool ElementArena::unpin( const void *p ){
+    /// give back a pinned node of a deleted owner
+    /*!
+      \param p the memory of the node, which is already destructed
+      \return true when \e p is in an orphaned arena. The arenas are
+      deleted when this was the last pinned node in them.
+      false when \e p is not in an arena, so it is heap memory.
+    */
+    if ( orphan_count.load( memory_order_relaxed ) == 0 ){
+      return false;
+    }
+    lock_guard<mutex> guard( orphan_lock );
+    for ( auto it = orphans.begin(); it != orphans.end(); ++it ){
+      for ( const auto& a : it->arenas ){
+	if ( a->owns( p ) ){
+	  if ( --it->pins == 0 ){
+	    for ( const auto& b : it->arenas ){
+	      delete b;
+	    }
+	    orphans.erase( it );
+	    --orphan_count;
+	  }
+	  return true;
+	}
+      }
+    }
+    return false;
+  }
+
+} // namespace folia
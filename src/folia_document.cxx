@@ -31,8 +31,18 @@
 #include <algorithm>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <bitset>
+#include <sys/stat.h>
 #include "config.h"
+#ifdef HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/XMLtools.h"
 #include "ticcutils/StringOps.h"
@@ -40,6 +50,7 @@
 #include "ticcutils/zipper.h"
 #include "libfolia/folia.h"
 #include "libfolia/folia_properties.h"
+#include "libfolia/folia_input.h"
 #include "libxml/xmlstring.h"
 
 using namespace std;
@@ -60,6 +71,13 @@ namespace folia {
   TiCC::LogStream DBG_CERR(cerr,NoStamp);
   /// connect to the default
   TiCC::LogStream *_dbg_file = &DBG_CERR;
+  /// the parse_job the current thread is working on, if any
+  thread_local Document::parse_job *Document::_parse_job = 0;
+
+  /// thrown in a worker thread when a subtree cannot be parsed on its own.
+  /// NOT derived from std::exception, so it passes 'catch( exception& )'
+  struct parallel_fallback {};
+
   ostream& operator<<( ostream& os,
 		       const Document::annotation_info& at ){
     /// output an annotation_info structure (Debugging only)
@@ -324,6 +342,10 @@ namespace folia {
     _incremental_parse = false;
     _preserve_spaces = false;
     _warn_count = 0;
+    _parse_threads = 0;
+    _has_text_caches = false;
+    _has_arenas = false;
+    _merged_jobs = 0;
     _major_version = 0;
     _minor_version = 0;
     _sub_version = 0;
@@ -341,15 +363,53 @@ namespace folia {
     xmlFree( const_cast<xmlChar*>(_foliaNsIn_href) );
     xmlFree( const_cast<xmlChar*>(_foliaNsIn_prefix) );
     sindex.clear();
-    if ( foliadoc ){
-      foliadoc->destroy();
-    }
-    set<FoliaElement*> bulk;
-    for ( const auto& it : delSet ){
-      it->unravel( bulk );
+    if ( !_arenas.empty() ){
+      // no need to take the tree apart node by node: just run the
+      // destructors and release the arenas in one go.
+      vector<FoliaElement*> bulk;
+      if ( foliadoc ){
+	foliadoc->gather( bulk );
+      }
+      for ( const auto& it : delSet ){
+	it->gather( bulk );
+      }
+      // Except for the detached nodes the caller still owns, which are not
+      // reached by gather(). Their arenas are kept until those are
+      // destroyed too. Their old parent is gone by then.
+      vector<FoliaElement*> pinned;
+      for ( const auto& it : _detached ){
+	if ( it->refcount() >= 0 ){
+	  it->set_parent( 0 );
+	  it->gather( pinned );
+	}
+      }
+      for ( const auto& it : bulk ){
+	it->release();
+      }
+      size_t pins = 0;
+      for ( const auto& it : pinned ){
+	if ( arena_node( dynamic_cast<void*>( it ) ) ){
+	  ++pins;
+	}
+	it->disown();
+      }
+      vector<ElementArena*> arenas;
+      for ( const auto& [dummy,a] : _arenas ){
+	arenas.push_back( a );
+      }
+      ElementArena::orphan( arenas, pins );
     }
-    for ( const auto& it : bulk ){
-      it->destroy();
+    else {
+      if ( foliadoc ){
+	foliadoc->destroy();
+      }
+      set<FoliaElement*> bulk;
+      for ( const auto& it : delSet ){
+	it->unravel( bulk );
+      }
+      for ( const auto& it : bulk ){
+	it->destroy();
+      }
     }
     delete _metadata;
     delete _foreign_metadata;
@@ -372,6 +432,12 @@ namespace folia {
       '(no)checktext' (default is checktext),
       '(no)fixtext' (default is NO),
       '(no)autodeclare' (default is NO)
+      '(no)stream' (default is NO)
+      '(no)arena' (default is NO) allocate the nodes in one memory pool.
+      '(no)cachetext' (default is NO) remember the text() of the nodes, until
+      the tree below them changes.
+      '(no)parallel[:N]' (default is NO) parse the body in N threads.
+      Without N, the number of available cores is used.
 
       example:
 
@@ -421,6 +487,38 @@ namespace folia {
       else if ( mod == "noexplicit" ){
 	mode = mode & ~DocMode::EXPLICIT;
       }
+      else if ( mod == "stream" ){
+	mode = mode | DocMode::STREAM;
+      }
+      else if ( mod == "nostream" ){
+	mode = mode & ~DocMode::STREAM;
+      }
+      else if ( mod == "arena" ){
+	set_arena( true );
+      }
+      else if ( mod == "noarena" ){
+	set_arena( false );
+      }
+      else if ( mod == "cachetext" ){
+	set_cachetext( true );
+      }
+      else if ( mod == "nocachetext" ){
+	set_cachetext( false );
+      }
+      else if ( mod == "parallel" ){
+	set_parse_threads( std::thread::hardware_concurrency() );
+      }
+      else if ( TiCC::match_front( mod, "parallel:" ) ){
+	unsigned int threads = 0;
+	if ( !TiCC::stringTo( mod.substr( 9 ), threads ) ){
+	  throw invalid_argument( "FoLiA::Document: invalid mode value: "
+				  + mod );
+	}
+	set_parse_threads( threads );
+      }
+      else if ( mod == "noparallel" ){
+	set_parse_threads( 0 );
+      }
       else {
 	throw invalid_argument( "FoLiA::Document: unsupported mode value: "+ mod );
       }
@@ -464,6 +562,18 @@ namespace folia {
     if ( mode % DocMode::EXPLICIT ){
       result += "explicit,";
     }
+    if ( mode % DocMode::STREAM ){
+      result += "stream,";
+    }
+    if ( mode % DocMode::ARENA ){
+      result += "arena,";
+    }
+    if ( mode % DocMode::CACHETEXT ){
+      result += "cachetext,";
+    }
+    if ( _parse_threads > 1 ){
+      result += "parallel:" + TiCC::toString( _parse_threads ) + ",";
+    }
     return result;
   }
 
@@ -580,6 +690,151 @@ namespace folia {
     return old_val;
   }
 
+  bool Document::set_streaming( bool new_val ) const{
+    /// sets the 'stream' mode to on/off
+    /*!
+      \param new_val the boolean to use for on/off
+      \return the previous value
+    */
+    bool old_val = (mode % DocMode::STREAM);
+    if ( new_val ){
+      mode = mode | DocMode::STREAM;
+    }
+    else {
+      mode = mode & ~DocMode::STREAM;
+    }
+    return old_val;
+  }
+
+  bool Document::set_arena( bool new_val ) const{
+    /// sets the 'arena' mode to on/off
+    /*!
+      \param new_val the boolean to use for on/off
+      \return the previous value
+
+      In arena mode, the nodes created while parsing (or using
+      FoliaElement::createElement()) are allocated in ElementArenas owned
+      by the Document. Switching it off again only affects new nodes.
+
+      Nodes taken out of the tree with remove() or replace(), and not
+      destroyed, stay valid when the Document is deleted: their arenas are
+      kept until the last of them is destroyed. They no longer belong to a
+      Document then. Any other pointer into the tree is invalid after
+      deleting the Document, as in normal mode.
+    */
+    bool old_val = (mode % DocMode::ARENA);
+    if ( new_val ){
+      mode = mode | DocMode::ARENA;
+    }
+    else {
+      mode = mode & ~DocMode::ARENA;
+    }
+    return old_val;
+  }
+
+  ElementArena *Document::element_arena() const {
+    /// return the arena for the nodes created by the current thread
+    /*!
+      Every thread gets an arena of its own, so allocating a node never
+      needs a lock. When the arena of this Document is already active on
+      this thread, that one is returned at once.
+      \return the ElementArena to use, or 0 when not in arena mode
+    */
+    if ( !arena() ){
+      return 0;
+    }
+    ElementArena *current = ElementArena::current();
+    if ( current && current->owner() == this ){
+      return current;
+    }
+    lock_guard<mutex> guard( _arena_mutex );
+    ElementArena*& result = _arenas[this_thread::get_id()];
+    if ( !result ){
+      result = new ElementArena( this, _arena_mutex );
+      _has_arenas = true;
+    }
+    return result;
+  }
+
+  bool Document::arena_node( const void *p ) const {
+    /// check if \e p points into one of the ElementArenas of this Document
+    /*!
+      \param p the address of a node
+      \return true when the memory of the node belongs to an arena
+    */
+    if ( !_has_arenas ){
+      return false;
+    }
+    lock_guard<mutex> guard( _arena_mutex );
+    for ( const auto& [dummy,a] : _arenas ){
+      if ( a->owns( p ) ){
+	return true;
+      }
+    }
+    return false;
+  }
+
+  void Document::keep_detached( FoliaElement *node ){
+    /// remember a node that is taken out of the tree, but not destroyed
+    /*!
+      \param node the node. Only nodes in an arena are remembered, so
+      ~Document() can keep their arenas.
+    */
+    if ( !_has_arenas ){
+      return;
+    }
+    void *mem = dynamic_cast<void*>( node );
+    lock_guard<mutex> guard( _arena_mutex );
+    for ( const auto& [dummy,a] : _arenas ){
+      if ( a->owns( mem ) ){
+	_detached.insert( node );
+	return;
+      }
+    }
+  }
+
+  void Document::forget_detached( FoliaElement *node ){
+    /// a node is destroyed, no need to remember it anymore
+    if ( !_has_arenas ){
+      return;
+    }
+    lock_guard<mutex> guard( _arena_mutex );
+    _detached.erase( node );
+  }
+
+  bool Document::set_cachetext( bool new_val ) const{
+    /// sets the 'cachetext' mode to on/off
+    /*!
+      \param new_val the boolean to use for on/off
+      \return the previous value
+
+      With 'cachetext' the nodes remember the result of text() calls. It is
+      forgotten when a node or one of its descendants is appended, removed or
+      replaced, or when the value of an XmlText changes. Changing attributes
+      like 'space' or a textclass directly is NOT noticed.
+    */
+    bool old_val = (mode % DocMode::CACHETEXT);
+    if ( new_val ){
+      mode = mode | DocMode::CACHETEXT;
+    }
+    else {
+      mode = mode & ~DocMode::CACHETEXT;
+    }
+    return old_val;
+  }
+
+  unsigned int Document::set_parse_threads( unsigned int threads ) const{
+    /// sets the number of threads to use for parsing the body
+    /*!
+      \param threads the number of threads. 0 or 1 means: no parallel parsing
+      \return the previous value
+    */
+    unsigned int old_val = _parse_threads;
+    _parse_threads = threads;
+    return old_val;
+  }
+
+
   void Document::set_dbg_stream( TiCC::LogStream *ls ){
     /// switch debugging to another LogStream
     if ( _dbg_file
@@ -600,6 +855,15 @@ namespace folia {
     if ( my_id.empty() ) {
       return;
     }
+    if ( _parse_job ){
+      // postpone until merge_subtree(), but check what we can now
+      if ( sindex.find( my_id ) != sindex.end()
+	   || !_parse_job->index.emplace( my_id, el ).second ){
+	throw DuplicateIDError( my_id );
+      }
+      _parse_job->ids.push_back( my_id );
+      return;
+    }
     auto it = sindex.find( my_id );
     if ( it == sindex.end() ){
       sindex[my_id] = el;
@@ -621,6 +885,10 @@ namespace folia {
     if ( id.empty() ) {
       return;
     }
+    if ( _parse_job ){
+      _parse_job->index.erase(id);
+      return;
+    }
     sindex.erase(id);
   }
 
@@ -683,26 +951,140 @@ namespace folia {
     return;
   }
 
+  namespace {
+    class mapped_file {
+      /// a read-only memory mapping of a regular file
+      /*!
+	When the file cannot be mapped (not a regular file, empty, or no
+	mmap() available) data() returns 0 and the caller should fall back
+	to normal reading.
+      */
+    public:
+      explicit mapped_file( const string& file_name ):
+	_data(0),
+	_size(0)
+      {
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+	int fd = ::open( file_name.c_str(), O_RDONLY );
+	if ( fd < 0 ){
+	  return;
+	}
+	struct stat st;
+	if ( fstat( fd, &st ) == 0
+	     && S_ISREG( st.st_mode )
+	     && st.st_size > 0 ){
+	  void *pnt = mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	  if ( pnt != MAP_FAILED ){
+	    madvise( pnt, st.st_size, MADV_SEQUENTIAL );
+	    _data = static_cast<const char*>(pnt);
+	    _size = st.st_size;
+	  }
+	}
+	::close( fd );
+#endif
+      }
+      ~mapped_file(){
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+	if ( _data ){
+	  munmap( const_cast<char*>(_data), _size );
+	}
+#endif
+      }
+      mapped_file( const mapped_file& ) = delete;
+      mapped_file& operator=( const mapped_file& ) = delete;
+      const char *data() const { return _data; };
+      size_t size() const { return _size; };
+    private:
+      const char *_data;
+      size_t _size;
+    };
+  }
+
   bool Document::read_from_file( const string& file_name ){
     /// read a FoLiA document from a file
     /*!
       \param file_name the name of the file
       \return true on succes. Will throw otherwise.
 
-      This function also takes care of files in .bz2 or .gz format when the
-      right extension is given.
+      This function also takes care of compressed files (gzip, bzip2, xz
+      and zstd, when available). The format is detected from the content.
+      Those are decompressed while parsing.
+
+      Uncompressed regular files are memory mapped. Other inputs, like
+      pipes, are read by libxml2 itself.
     */
-    ifstream is( file_name );
-    if ( !is.good() ){
+    struct stat st;
+    if ( stat( file_name.c_str(), &st ) != 0 ){
       throw invalid_argument( "file not found: " + file_name );
     }
     if ( foliadoc ){
       throw logic_error( "Document is already initialized" );
     }
     _source_name = file_name;
-    if ( TiCC::match_back( file_name, ".bz2" ) ){
-      string buffer = TiCC::bz2ReadFile( file_name );
-      return read_from_string( buffer );
+    // opening a pipe just to look at it would lose the input
+    const bool regular = S_ISREG( st.st_mode );
+    Compression comp = regular ? detect_compression( file_name )
+      : Compression::NONE;
+    if ( comp != Compression::NONE ){
+      if ( has_decompressor( comp ) ){
+	if ( debug % DEBUG_FLAGS::PARSING ){
+	  cout << "decompressing " << toString( comp ) << " input from "
+	       << file_name << endl;
+	}
+	if ( read_from_decompressor( create_decompressor( file_name, comp ) ) ){
+	  return true;
+	}
+	if ( debug % DEBUG_FLAGS::PARSING ){
+	  cout << "Failed to read a doc from " << file_name << endl;
+	}
+	throw DocumentError( file_name, "No valid FoLiA read" );
+      }
+      else if ( comp == Compression::BZIP2 ){
+	const string buffer = TiCC::bz2ReadFile( file_name );
+	if ( read_from_memory( buffer.c_str(), buffer.length(),
+			       file_name.c_str() ) ){
+	  return true;
+	}
+	throw DocumentError( file_name, "No valid FoLiA read" );
+      }
+      else if ( comp == Compression::ZSTD ){
+	throw DocumentError( file_name,
+			     "no support for zstd compressed input" );
+      }
+      // gzip or xz. libxml2 may be able to handle it
+    }
+    else if ( regular ){
+      mapped_file input( file_name );
+      if ( input.data() ){
+	if ( debug % DEBUG_FLAGS::PARSING ){
+	  cout << "mapped " << input.size() << " bytes from " << file_name
+	       << endl;
+	}
+	if ( read_from_memory( input.data(), input.size(),
+			       file_name.c_str() ) ){
+	  return true;
+	}
+	if ( debug % DEBUG_FLAGS::PARSING ){
+	  cout << "Failed to read a doc from " << file_name << endl;
+	}
+	throw DocumentError( file_name, "No valid FoLiA read" );
+      }
+    }
+    // not mappable, or no decompressor. Let libxml2 handle it
+    if ( streaming() ){
+      if ( debug % DEBUG_FLAGS::PARSING ){
+	cout << "streaming a doc from " << file_name << endl;
+      }
+      xmlTextReader *reader = xmlReaderForFile( file_name.c_str(),
+						0,
+						XML_PARSER_OPTIONS );
+      if ( read_from_reader( reader ) ){
+	return true;
+      }
+      if ( debug % DEBUG_FLAGS::PARSING ){
+	cout << "Failed to read a doc from " << file_name << endl;
+      }
+      throw DocumentError( file_name, "No valid FoLiA read" );
     }
     int cnt = 0;
     xmlSetStructuredErrorFunc( &cnt, (xmlStructuredErrorFunc)error_sink );
@@ -716,22 +1098,7 @@ namespace folia {
       if ( debug % DEBUG_FLAGS::PARSING ){
 	cout << "read a doc from " << file_name << endl;
       }
-      foliadoc = parseXml();
-      if ( !validate_offsets() ){
-	// cannot happen. validate_offsets() throws on error
-	throw InconsistentText("MEH");
-      }
-      if ( debug % DEBUG_FLAGS::PARSING ){
-	if ( foliadoc ){
-	  cout << "successful parsed the doc from: " << file_name << endl;
-	}
-	else {
-	  cout << "failed to parse the doc from: " << file_name << endl;
-	}
-      }
-      xmlFreeDoc( _xmldoc );
-      _xmldoc = 0;
-      return foliadoc != 0;
+      return parse_xmldoc();
     }
     if ( debug % DEBUG_FLAGS::PARSING ){
       cout << "Failed to read a doc from " << file_name << endl;
@@ -748,39 +1115,143 @@ namespace folia {
     if ( foliadoc ){
       throw logic_error( "Document is already initialized" );
     }
+    _source_name = "memory-buffer";
+    if ( read_from_memory( buffer.c_str(), buffer.length(), 0 ) ){
+      return true;
+    }
+    if ( debug % DEBUG_FLAGS::PARSING ){
+      throw runtime_error( "Failed to read a doc from a string" );
+    }
+    return false;
+  }
+
+  bool Document::read_from_memory( const char *buffer,
+				   size_t len,
+				   const char *url ){
+    /// read a FoLiA Document from a memory region
+    /*!
+      \param buffer pointer to a complete FoLiA document
+      \param len the size of the buffer in bytes
+      \param url the name of the input, used by libxml2 in error messages.
+      May be 0
+      \return true on succes, false when the XML could not be read.
+      Will throw on FoLiA errors.
+
+      Errors are reported using _source_name
+
+      In stream mode the xmlTextReader reads buffer in place. In DOM mode
+      xmlReadMemory() may still copy it into the input buffer of libxml2.
+     */
+    if ( streaming() ){
+      if ( debug % DEBUG_FLAGS::PARSING ){
+	cout << "streaming a doc from memory" << endl;
+      }
+      xmlTextReader *reader = xmlReaderForMemory( buffer, len,
+						  url, 0,
+						  XML_PARSER_OPTIONS );
+      return read_from_reader( reader );
+    }
     int cnt = 0;
     xmlSetStructuredErrorFunc( &cnt, (xmlStructuredErrorFunc)error_sink );
-    _xmldoc = xmlReadMemory( buffer.c_str(), buffer.length(), 0, 0,
-			     XML_PARSER_OPTIONS );
-    if ( _xmldoc ){
-      _source_name = "memory-buffer";
-      if ( cnt > 0 ){
-	throw DocumentError( _source_name, "document is invalid" );
+    _xmldoc = xmlReadMemory( buffer, len, url, 0, XML_PARSER_OPTIONS );
+    if ( !_xmldoc ){
+      return false;
+    }
+    if ( cnt > 0 ){
+      throw DocumentError( _source_name, "document is invalid" );
+    }
+    if ( debug % DEBUG_FLAGS::PARSING ){
+      cout << "read a doc from memory" << endl;
+    }
+    return parse_xmldoc();
+  }
+
+  bool Document::read_from_decompressor( Decompressor *dc ){
+    /// read a FoLiA Document while decompressing the input
+    /*!
+      \param dc the Decompressor to read from. It is deleted afterwards.
+      \return true on succes, false when the XML could not be read.
+      Will throw on FoLiA errors, and a DocumentError on corrupt or truncated
+      compressed input.
+     */
+    if ( streaming() ){
+      bool result = false;
+      try {
+	result = read_from_reader( decompress_reader( dc ) );
       }
-      if ( debug % DEBUG_FLAGS::PARSING ){
-	cout << "read a doc from string" << endl;
+      catch ( ... ){
+	check_decompress_error();
+	throw;
       }
-      foliadoc = parseXml();
-      if ( !validate_offsets() ){
-	// cannot happen. validate_offsets() throws on error
-	throw InconsistentText("MEH");
+      check_decompress_error();
+      return result;
+    }
+    int cnt = 0;
+    xmlSetStructuredErrorFunc( &cnt, (xmlStructuredErrorFunc)error_sink );
+    _xmldoc = decompress_xmldoc( dc );
+    check_decompress_error();
+    if ( !_xmldoc ){
+      return false;
+    }
+    if ( cnt > 0 ){
+      throw DocumentError( _source_name, "document is invalid" );
+    }
+    return parse_xmldoc();
+  }
+
+  bool Document::parse_xmldoc(){
+    /// build the FoLiA tree from the libxml2 document in _xmldoc
+    /*!
+      \return true on succes. Will throw otherwise.
+      _xmldoc is freed afterwards
+     */
+    foliadoc = parseXml();
+    if ( !validate_offsets() ){
+      // cannot happen. validate_offsets() throws on error
+      throw InconsistentText("MEH");
+    }
+    if ( debug % DEBUG_FLAGS::PARSING ){
+      if ( foliadoc ){
+	cout << "successful parsed the doc from: " << _source_name << endl;
       }
-      if ( debug % DEBUG_FLAGS::PARSING ){
-	if ( foliadoc ){
-	  cout << "successful parsed the doc" << endl;
-	}
-	else{
-	  cout << "failed to parse the doc" << endl;
-	}
+      else {
+	cout << "failed to parse the doc from: " << _source_name << endl;
       }
-      xmlFreeDoc( _xmldoc );
-      _xmldoc = 0;
-      return foliadoc != 0;
+    }
+    xmlFreeDoc( _xmldoc );
+    _xmldoc = 0;
+    return foliadoc != 0;
+  }
+
+  bool Document::read_from_reader( xmlTextReader *reader ){
+    /// read a FoLiA Document from an xmlTextReader, without building a DOM
+    /*!
+      \param reader the xmlTextReader to use. It is freed afterwards.
+      \return true on succes, false when the XML could not be read.
+      Will throw on FoLiA errors.
+     */
+    if ( !reader ){
+      return false;
+    }
+    try {
+      foliadoc = parse_stream( reader );
+    }
+    catch ( ... ){
+      xmlFreeTextReader( reader );
+      throw;
+    }
+    xmlFreeTextReader( reader );
+    if ( !foliadoc ){
+      return false;
+    }
+    if ( !validate_offsets() ){
+      // cannot happen. validate_offsets() throws on error
+      throw InconsistentText("MEH");
     }
     if ( debug % DEBUG_FLAGS::PARSING ){
-      throw runtime_error( "Failed to read a doc from a string" );
+      cout << "successful parsed the doc from: " << _source_name << endl;
     }
-    return false;
+    return true;
   }
 
   ostream& operator<<( ostream& os, const Document *d ){
@@ -871,6 +1342,15 @@ namespace folia {
       \return the FoliaElement with this \e id or 0, when not present
      */
     const auto& it = sindex.find( id );
+    if ( _parse_job && it == sindex.end() ){
+      const auto& jit = _parse_job->index.find( id );
+      if ( jit != _parse_job->index.end() ){
+	return jit->second;
+      }
+      // it might be in a subtree parsed by another thread
+      _parse_job->fallback = true;
+      throw parallel_fallback();
+    }
     if ( it == sindex.end() ){
       return 0;
     }
@@ -928,9 +1408,205 @@ namespace folia {
   static const set<ElementType> quoteSet = { ElementType::Quote_t };
   static const set<ElementType> emptySet;
 
+  static void add_span_refs( const FoliaElement *el,
+			     unordered_map<const FoliaElement*,
+			     vector<AbstractSpanAnnotation*>>& index ){
+    /// register all span annotations below el in the reverse index
+    /*!
+      \param el the node to start at
+      \param index the word to span index to fill
+      Spans are visited in document order, so every list in index is too.
+    */
+    for ( const auto& child : el->data() ){
+      if ( child->is_a( ElementType::AbstractSpanAnnotation_t ) ){
+	AbstractSpanAnnotation *span
+	  = dynamic_cast<AbstractSpanAnnotation*>( child );
+	for ( const auto& ref : span->wrefs_view() ){
+	  index[ref].push_back( span );
+	}
+      }
+      add_span_refs( child, index );
+    }
+  }
+
+  static bitset<ELEMENT_TYPE_COUNT> type_bits( ElementType super ){
+    /// return a bitset with all ElementTypes that are a subtype of super
+    bitset<ELEMENT_TYPE_COUNT> result;
+    for ( ElementType et = ElementType::BASE;
+	  et < ElementType::LastElement;
+	  ++et ){
+      if ( is_subtype( et, super ) ){
+	result.set( static_cast<size_t>(et) );
+      }
+    }
+    return result;
+  }
+
+  static bool holds( const FoliaElement *el,
+		     const bitset<ELEMENT_TYPE_COUNT>& types ){
+    /// check if el, or any node below it, has one of the given types
+    /*!
+      \param el the node to check
+      \param types the ElementTypes we look for
+      \return true when found
+
+      Subtrees that contained_types() rules out are skipped, so for most
+      annotations this only looks at el itself.
+    */
+    ElementType et = el->element_id();
+    if ( et < ElementType::LastElement
+	 && types.test( static_cast<size_t>(et) ) ){
+      return true;
+    }
+    if ( !( contained_types( et ) & types ).any() ){
+      return false;
+    }
+    for ( const auto& child : el->data() ){
+      if ( holds( child, types ) ){
+	return true;
+      }
+    }
+    return false;
+  }
+
+  void Document::invalidate_index( const FoliaElement *parent,
+				   const FoliaElement *child ) const {
+    /// forget the cached lists that may change when a child is added to or
+    /// removed from a node
+    /*!
+      \param parent the node that changed
+      \param child the added or removed child. For a change of the node
+      itself (like a new value of an XmlText) this is the node too
+
+      Only the lists that child, or the subtree below it, can be part of
+      are marked. So adding a PosAnnotation or a TextContent, or changing a
+      text, keeps them all.
+      Annotation layers and span annotations only refer to Words, which
+      are not part of words() through them. So a change in a layer or a
+      span only marks the span index.
+    */
+    static const bitset<ELEMENT_TYPE_COUNT> span_bits
+      = type_bits( ElementType::AbstractSpanAnnotation_t );
+    static const bitset<ELEMENT_TYPE_COUNT> word_bits
+      = type_bits( ElementType::Word_t );
+    static const bitset<ELEMENT_TYPE_COUNT> sentence_bits
+      = type_bits( ElementType::Sentence_t )
+      | type_bits( ElementType::Quote_t );
+    static const bitset<ELEMENT_TYPE_COUNT> paragraph_bits
+      = type_bits( ElementType::Paragraph_t );
+    unsigned char built = _index_built.load( memory_order_relaxed )
+      & ~_index_dirty.load( memory_order_relaxed );
+    if ( !built ){
+      // nothing to forget. (Always the case while parsing)
+      return;
+    }
+    unsigned char touched = 0;
+    auto check = [&]( doc_index which,
+		      const bitset<ELEMENT_TYPE_COUNT>& types ){
+      unsigned char bit = static_cast<unsigned char>(which);
+      if ( ( built & bit ) && holds( child, types ) ){
+	touched |= bit;
+      }
+    };
+    if ( parent->is_a( ElementType::AbstractAnnotationLayer_t )
+	 || parent->is_a( ElementType::AbstractSpanAnnotation_t )
+	 || child->is_a( ElementType::AbstractAnnotationLayer_t )
+	 || child->is_a( ElementType::AbstractSpanAnnotation_t ) ){
+      touched = static_cast<unsigned char>(doc_index::SPANS);
+    }
+    else {
+      check( doc_index::SPANS, span_bits );
+      check( doc_index::WORDS, word_bits );
+      if ( touched & static_cast<unsigned char>(doc_index::WORDS) ){
+	touched |= static_cast<unsigned char>(doc_index::WORD_POSITIONS);
+      }
+      check( doc_index::SENTENCES, sentence_bits );
+      check( doc_index::PARAGRAPHS, paragraph_bits );
+    }
+    touched &= built;
+    if ( touched ){
+      _index_dirty.fetch_or( touched, memory_order_relaxed );
+    }
+  }
+
+  void Document::check_index( doc_index which ) const {
+    /// make sure the cached list for \e which is up to date
+    /*!
+      \param which the list we need
+
+      After a change in the tree (see invalidate_index()) the lists that
+      might be affected are marked. A marked list is only discarded and
+      rebuilt when it is asked for, using the same select() as the uncached
+      versions did. The other lists keep their marks.
+    */
+    lock_guard<mutex> lock( _index_mutex );
+    unsigned char bit = static_cast<unsigned char>(which);
+    unsigned char mask = bit;
+    if ( which == doc_index::WORD_POSITIONS ){
+      // the positions are derived from the Word list
+      mask |= static_cast<unsigned char>(doc_index::WORDS);
+    }
+    unsigned char built = _index_built.load( memory_order_relaxed );
+    unsigned char dirty = _index_dirty.fetch_and( ~mask, memory_order_relaxed )
+      & mask & built;
+    if ( dirty ){
+      if ( dirty & static_cast<unsigned char>(doc_index::WORDS) ){
+	_word_index.clear();
+      }
+      if ( dirty & static_cast<unsigned char>(doc_index::WORD_POSITIONS) ){
+	_word_positions.clear();
+      }
+      if ( dirty & static_cast<unsigned char>(doc_index::SPANS) ){
+	_span_index.clear();
+      }
+      if ( dirty & static_cast<unsigned char>(doc_index::SENTENCES) ){
+	_sentence_index.clear();
+      }
+      if ( dirty & static_cast<unsigned char>(doc_index::PARAGRAPHS) ){
+	_paragraph_index.clear();
+      }
+      built &= ~dirty;
+    }
+    if ( built & bit ){
+      _index_built.store( built, memory_order_relaxed );
+      return;
+    }
+    if ( which == doc_index::WORD_POSITIONS
+	 && !(built & static_cast<unsigned char>(doc_index::WORDS)) ){
+      if ( foliadoc ){
+	_word_index = foliadoc->select<Word>( default_ignore_structure );
+      }
+      built |= static_cast<unsigned char>(doc_index::WORDS);
+    }
+    if ( foliadoc ){
+      switch ( which ){
+      case doc_index::WORDS:
+	_word_index = foliadoc->select<Word>( default_ignore_structure );
+	break;
+      case doc_index::WORD_POSITIONS:
+	_word_positions.reserve( _word_index.size() );
+	for ( size_t i=0; i < _word_index.size(); ++i ){
+	  _word_positions.emplace( _word_index[i], i );
+	}
+	break;
+      case doc_index::SENTENCES:
+	_sentence_index = foliadoc->select<Sentence>( quoteSet );
+	break;
+      case doc_index::PARAGRAPHS:
+	_paragraph_index = foliadoc->select<Paragraph>();
+	break;
+      case doc_index::SPANS:
+	add_span_refs( foliadoc, _span_index );
+	break;
+      }
+    }
+    _index_built.store( built | bit, memory_order_relaxed );
+  }
+
   vector<Sentence*> Document::sentences() const {
     /// return all Sentences in the Document, except those in Quotes
-    return foliadoc->select<Sentence>( quoteSet );
+    check_index( doc_index::SENTENCES );
+    return _sentence_index;
   }
 
   vector<Sentence*> Document::sentenceParts() const {
@@ -946,9 +1622,9 @@ namespace folia {
       \return The Sentence found.
       will throw when the index is out of range
     */
-    vector<Sentence*> v = sentences();
-    if ( index < v.size() ){
-      return v[index];
+    check_index( doc_index::SENTENCES );
+    if ( index < _sentence_index.size() ){
+      return _sentence_index[index];
     }
     throw range_error( "sentences() index out of range" );
   }
@@ -960,9 +1636,9 @@ namespace folia {
       \return The Sentence found.
       will throw when the index is out of range
     */
-    vector<Sentence*> v = sentences();
-    if ( index < v.size() ){
-      return v[v.size()-1-index];
+    check_index( doc_index::SENTENCES );
+    if ( index < _sentence_index.size() ){
+      return _sentence_index[_sentence_index.size()-1-index];
     }
     throw range_error( "rsentences() index out of range" );
   }
@@ -973,7 +1649,8 @@ namespace folia {
     /*!
       \return The Words found.
     */
-    return foliadoc->select<Word>( default_ignore_structure );
+    check_index( doc_index::WORDS );
+    return _word_index;
   }
 
   Word *Document::words( size_t index ) const {
@@ -984,9 +1661,9 @@ namespace folia {
       \return The Word found.
       will throw when the index is out of range
     */
-    vector<Word*> v = words();
-    if ( index < v.size() ){
-      return v[index];
+    check_index( doc_index::WORDS );
+    if ( index < _word_index.size() ){
+      return _word_index[index];
     }
     throw range_error( "words() index out of range" );
   }
@@ -999,16 +1676,54 @@ namespace folia {
       \return The Word found.
       will throw when the index is out of range
     */
-    vector<Word*> v = words();
-    if ( index < v.size() ){
-      return v[v.size()-1-index];
+    check_index( doc_index::WORDS );
+    if ( index < _word_index.size() ){
+      return _word_index[_word_index.size()-1-index];
     }
     throw range_error( "rwords() index out of range" );
   }
 
+  size_t Document::word_count() const {
+    /// return the number of Words in the Document, as returned by words()
+    check_index( doc_index::WORDS );
+    return _word_index.size();
+  }
+
+  size_t Document::word_position( const Word *word ) const {
+    /// return the position of a Word in the Document
+    /*!
+      \param word the Word to look up
+      \return the index of word in words(), or word_count() when word is not
+      part of that list (e.g. when it is inside an Alternative).
+    */
+    check_index( doc_index::WORD_POSITIONS );
+    const auto& it = _word_positions.find( word );
+    if ( it == _word_positions.end() ){
+      return _word_index.size();
+    }
+    return it->second;
+  }
+
+  vector<AbstractSpanAnnotation*> Document::spans_of( const FoliaElement *ref ) const {
+    /// return all span annotations that refer to a node
+    /*!
+      \param ref the (referable) node to look up. Mostly a Word
+      \return all span annotations anywhere in the Document that include ref
+      in their wrefs(), in document order. A span that refers to ref more
+      then once, is listed as many times.
+    */
+    check_index( doc_index::SPANS );
+    const auto& it = _span_index.find( ref );
+    if ( it == _span_index.end() ){
+      return {};
+    }
+    return it->second;
+  }
+
   vector<Paragraph*> Document::paragraphs() const {
     /// return all Paragraphs in the Document
-    return foliadoc->select<Paragraph>();
+    check_index( doc_index::PARAGRAPHS );
+    return _paragraph_index;
   }
 
   Paragraph *Document::paragraphs( size_t index ) const {
@@ -1018,9 +1733,9 @@ namespace folia {
       \return The Paragraph found.
       will throw when the index is out of range
     */
-    vector<Paragraph*> v = paragraphs();
-    if ( index < v.size() ){
-      return v[index];
+    check_index( doc_index::PARAGRAPHS );
+    if ( index < _paragraph_index.size() ){
+      return _paragraph_index[index];
     }
     throw range_error( "paragraphs() index out of range" );
   }
@@ -1032,9 +1747,9 @@ namespace folia {
       \return The Paragraph found.
       will throw when the index is out of range
     */
-    vector<Paragraph*> v = paragraphs();
-    if ( index < v.size() ){
-      return v[v.size()-1-index];
+    check_index( doc_index::PARAGRAPHS );
+    if ( index < _paragraph_index.size() ){
+      return _paragraph_index[_paragraph_index.size()-1-index];
     }
     throw range_error( "rparagraphs() index out of range" );
   }
@@ -1896,7 +2611,36 @@ namespace folia {
       it->second = href;
     }
     else {
-      styles.insert( make_pair( type, href ) );
+      styles.insert( make_pair( type, href ) );
+    }
+  }
+
+  void Document::parse_style_pi( const string& content, long int line ){
+    /// add the style-sheet described in an xml-stylesheet PI
+    /*!
+      \param content the content of the Processing Instruction
+      \param line the line number of the PI, used in error messages
+    */
+    string type;
+    string href;
+    vector<string> v = TiCC::split( content );
+    if ( v.size() == 2 ){
+      vector<string> w = TiCC::split_at( v[0], "=" );
+      if ( w.size() == 2 && w[0] == "type" ){
+	type = w[1].substr(1,w[1].length()-2);
+      }
+      w = TiCC::split_at( v[1], "=" );
+      if ( w.size() == 2 && w[0] == "href" ){
+	href = w[1].substr(1,w[1].length()-2);
+      }
+    }
+    if ( !type.empty() && !href.empty() ){
+      addStyle( type, href );
+    }
+    else {
+      throw DocumentError( _source_name,
+			   "problem parsing line: " + content,
+			   line );
     }
   }
 
@@ -1906,28 +2650,7 @@ namespace folia {
     while ( pnt ){
       // search for Processing Instructions, ignore all but stylesheet ones
       if ( pnt->type == XML_PI_NODE && TiCC::Name(pnt) == "xml-stylesheet" ){
-	string content = TextValue(pnt);
-	string type;
-	string href;
-	vector<string> v = TiCC::split( content );
-	if ( v.size() == 2 ){
-	  vector<string> w = TiCC::split_at( v[0], "=" );
-	  if ( w.size() == 2 && w[0] == "type" ){
-	    type = w[1].substr(1,w[1].length()-2);
-	  }
-	  w = TiCC::split_at( v[1], "=" );
-	  if ( w.size() == 2 && w[0] == "href" ){
-	    href = w[1].substr(1,w[1].length()-2);
-	  }
-	}
-	if ( !type.empty() && !href.empty() ){
-	  addStyle( type, href );
-	}
-	else {
-	  throw DocumentError( _source_name,
-			       "problem parsing line: " + content,
-			       xmlGetLineNo(pnt) );
-      }
+	parse_style_pi( TextValue(pnt), xmlGetLineNo(pnt) );
       }
       else if ( pnt->type == XML_COMMENT_NODE ) {
 	string xml_tag = "_XmlComment";
@@ -2111,9 +2834,18 @@ namespace folia {
 			       + NSFOLIA + " but found: " + ns );
 	}
 	try {
+	  AbstractElement::parse_scope texts;
+	  ElementArena::scope nodes( element_arena() );
 	  FoLiA *folia = new FoLiA( this );
-	  result = folia->parseXml( root );
-	  resolveExternals();
+	  try {
+	    result = folia->parseXml( root );
+	    resolveExternals();
+	  }
+	  catch ( ... ){
+	    // don't leave a partial tree behind
+	    folia->destroy();
+	    throw;
+	  }
 	}
 	catch ( const InconsistentText& e ){
 	  throw;
@@ -2145,6 +2877,602 @@ namespace folia {
     return result;
   }
 
+  FoliaElement* Document::parse_stream( xmlTextReader *reader ){
+    /// parse a complete FoLiA tree directly from an xmlTextReader
+    /*!
+      \param reader an xmlTextReader positioned before the first node
+      \return the root of the FoLiA Document, or 0 when the XML itself is
+      invalid. Throws on FoLiA errors.
+
+      This is the STREAM mode counterpart of parseXml(). No complete xmlDoc
+      is built: structure elements (\<text\>, \<div\>, \<p\>, \<s\>, \<w\>
+      etc.) are created at their start tag and completed at their end tag.
+      All other subtrees (metadata, inline and span annotations, text
+      content, ...) are expanded one at a time and handed to their own
+      parseXml(). The reader releases them again when moving on.
+
+      The results (declarations, text checks, errors) are the same as with
+      parseXml().
+    */
+    struct open_node {
+      FoliaElement *elt;     // the FoLiA element under construction
+      std::string tag;       // its XML tag
+      std::string last_tag;  // the XML name of the last child seen
+    };
+    AbstractElement::parse_scope texts;
+    ElementArena::scope nodes( element_arena() );
+    vector<open_node> stack;
+    FoliaElement *result = 0;
+    bool meta_found = false;
+    bool no_ns = false; // a permissive document without a FoLiA namespace
+    int cnt = 0;
+    xmlSetStructuredErrorFunc( &cnt, (xmlStructuredErrorFunc)error_sink );
+    auto cleanup = [&](){
+      // remove the elements under construction. They are not attached
+      // to their parents yet. stack[0] (if any) is the root
+      if ( stack.empty() ){
+	if ( result ){
+	  result->destroy();
+	}
+      }
+      while ( !stack.empty() ){
+	stack.back().elt->destroy();
+	stack.pop_back();
+      }
+      result = 0;
+    };
+    auto expand = [&]() -> const xmlNode* {
+      // expand the current subtree into a (temporary) xmlNode tree
+      // returns 0 when the XML is broken
+      xmlNode *sub = xmlTextReaderExpand( reader );
+      if ( !sub ){
+	return 0;
+      }
+      if ( cnt > 0 ){
+	throw DocumentError( _source_name, "document is invalid" );
+      }
+      if ( no_ns ){
+	xmlNs *def_ns = xmlNewNs( sub, _foliaNsIn_href, 0 );
+	xmlSetNs( sub, def_ns );
+	fixupNs( sub->children, def_ns );
+      }
+      return sub;
+    };
+    auto close_top = [&](){
+      // the current top of the stack is complete. check it and add it
+      // to its parent
+      FoliaElement *t = stack.back().elt;
+      stack.pop_back();
+      if ( stack.empty() ){
+	// the FoLiA root
+	return;
+      }
+      if ( ( checktext() || fixtext() )
+	   && t->printable()
+	   && !t->isSubClass<Morpheme>() && !t->isSubClass<Phoneme>() ){
+	t->check_text_consistency_while_parsing( true,
+						 debug % DocDbg::TEXTHANDLING );
+      }
+      if ( debug % DocDbg::PARSING ) {
+	DBG << "extend " << stack.back().elt << " met " << t << endl;
+      }
+      stack.back().elt->append( t );
+    };
+    int ret = xmlTextReaderRead( reader );
+    bool broken = false;
+    try {
+      try {
+	while ( ret == 1 ){
+	  if ( cnt > 0 ){
+	    throw DocumentError( _source_name, "document is invalid" );
+	  }
+	  bool skip = false; // when true, continue AFTER the current subtree
+	  int type = xmlTextReaderNodeType( reader );
+	  xmlNode *node = xmlTextReaderCurrentNode( reader );
+	  if ( stack.empty() ){
+	    // outside the root node
+	    if ( type == XML_READER_TYPE_ELEMENT && !result ){
+	      if ( node->ns ){
+		if ( node->ns->prefix ){
+		  _foliaNsIn_prefix = xmlStrdup( node->ns->prefix );
+		}
+		_foliaNsIn_href = xmlStrdup( node->ns->href );
+	      }
+	      if ( debug % DEBUG_FLAGS::PARSING ){
+		string dum;
+		DBG << "root = " << TiCC::Name( node ) << endl;
+		DBG << "in namespace " << TiCC::getNS( node, dum ) << endl;
+		DBG << "namespace list" << TiCC::getDefinedNS( node ) << endl;
+	      }
+	      if ( TiCC::Name( node ) == "FoLiA" ){
+		string ns = TiCC::getNS( node );
+		if ( ns.empty() ){
+		  if ( permissive() ){
+		    _foliaNsIn_href = xmlCharStrdup( NSFOLIA.c_str() );
+		    _foliaNsIn_prefix = 0;
+		    no_ns = true;
+		  }
+		  else {
+		    throw DocumentError( _source_name,
+					 "Folia Document should have namespace declaration "
+					 + NSFOLIA + " but none found " );
+		  }
+		}
+		else if ( ns != NSFOLIA ){
+		  throw DocumentError( _source_name,
+				       "Folia Document should have namespace declaration "
+				       + NSFOLIA + " but found: " + ns );
+		}
+		result = new FoLiA( this );
+		KWargs atts = getAttributes( node );
+		result->setAttributes( atts );
+		result->set_line_number( xmlGetLineNo(node) );
+		stack.push_back( { result, "FoLiA", "" } );
+		if ( xmlTextReaderIsEmptyElement( reader ) ){
+		  close_top();
+		}
+	      }
+	      else if ( TiCC::Name( node ) == "DCOI" &&
+			checkNS( node, NSDCOI ) ){
+		throw DocumentError( _source_name, "DCOI format not supported" );
+	      }
+	      else {
+		throw DocumentError( _source_name, "root node must be FoLiA" );
+	      }
+	    }
+	    else if ( type == XML_READER_TYPE_PROCESSING_INSTRUCTION ){
+	      if ( TiCC::Name( node ) == "xml-stylesheet" ){
+		parse_style_pi( TextValue(node), xmlGetLineNo(node) );
+	      }
+	    }
+	    else if ( type == XML_READER_TYPE_COMMENT ){
+	      FoliaElement *t = AbstractElement::createElement( "_XmlComment",
+								this );
+	      if ( debug % DEBUG_FLAGS::PARSING ) {
+		DBG << "created " << t << endl;
+	      }
+	      t = t->parseXml( node );
+	      if ( t ) {
+		if ( debug % DEBUG_FLAGS::PARSING ) {
+		  DBG << "extend " << this << " met " << t << endl;
+		}
+		preludes.push_back(t);
+	      }
+	    }
+	  }
+	  else {
+	    open_node& current = stack.back();
+	    FoliaElement *parent = current.elt;
+	    bool at_root = ( stack.size() == 1 );
+	    parent->set_line_number( xmlGetLineNo(node) );
+	    switch ( type ){
+	    case XML_READER_TYPE_ELEMENT: {
+	      skip = true;
+	      string pref;
+	      string tag = TiCC::Name( node );
+	      string ns = TiCC::getNS( node, pref );
+	      if ( no_ns && ns.empty() ){
+		ns = NSFOLIA;
+	      }
+	      if ( at_root && tag == "metadata" && ns == NSFOLIA ){
+		if ( debug % DocDbg::PARSING ){
+		  DBG << "Found metadata" << endl;
+		}
+		current.last_tag = tag;
+		const xmlNode *sub = expand();
+		if ( !sub ){
+		  broken = true;
+		  break;
+		}
+		parse_metadata( sub );
+		meta_found = true;
+	      }
+	      else if ( at_root && ns != NSFOLIA ){
+		// just ignore
+		current.last_tag = tag;
+	      }
+	      else if ( !ns.empty() && ns != NSFOLIA ){
+		// skip alien nodes
+		if ( debug % DocDbg::PARSING ) {
+		  DBG << "skipping non-FoLiA node: " << pref << ":" << tag << endl;
+		}
+		current.last_tag = tag;
+	      }
+	      else {
+		if ( at_root && !meta_found && !version_below(1,6) ){
+		  if ( autodeclare() ){
+		    fixup_metadata();
+		    meta_found = true;
+		  }
+		  else {
+		    throw XmlError( parent,
+				    "Expecting element metadata, got '" + tag + "'" );
+		  }
+		}
+		FoliaElement *t = 0;
+		try {
+		  t = AbstractElement::createElement( tag, this );
+		}
+		catch ( const exception& e ){
+		  if ( at_root || !permissive() ){
+		    throw XmlError( parent,
+				    string( "parsing <" ) + tag + "> failed:\n\t"
+				    + e.what() );
+		  }
+		}
+		current.last_tag = tag;
+		if ( !t ){
+		  break;
+		}
+		if ( debug % DocDbg::PARSING ) {
+		  DBG << "created " << t << endl;
+		}
+		if ( t->isSubClass<AbstractStructureElement>() ){
+		  // handle the attributes now, and the children while reading on
+		  KWargs atts = getAttributes( node );
+		  int sp = xmlNodeGetSpacePreserve( node );
+		  if ( sp == 1 ){
+		    atts.add("xml:space","preserve");
+		  }
+		  else if ( sp == 0 ){
+		    atts.add("xml:space","default");
+		  }
+		  try {
+		    t->setAttributes( atts );
+		  }
+		  catch ( ... ){
+		    t->destroy();
+		    throw;
+		  }
+		  t->set_line_number( xmlGetLineNo(node) );
+		  stack.push_back( { t, tag, "" } );
+		  if ( xmlTextReaderIsEmptyElement( reader ) ){
+		    close_top();
+		  }
+		  skip = false;
+		}
+		else {
+		  const xmlNode *sub = expand();
+		  if ( !sub ){
+		    t->destroy();
+		    broken = true;
+		    break;
+		  }
+		  try {
+		    t = t->parseXml( sub );
+		  }
+		  catch ( ... ){
+		    t->destroy();
+		    throw;
+		  }
+		  if ( t ){
+		    if ( debug % DocDbg::PARSING ) {
+		      DBG << "extend " << parent << " met " << t << endl;
+		    }
+		    parent->append( t );
+		  }
+		}
+	      }
+	    }
+	      break;
+	    case XML_READER_TYPE_END_ELEMENT:
+	      close_top();
+	      if ( !stack.empty() ){
+		stack.back().last_tag = TiCC::Name( node );
+	      }
+	      break;
+	    case XML_READER_TYPE_PROCESSING_INSTRUCTION:
+	    case XML_READER_TYPE_COMMENT: {
+	      current.last_tag = TiCC::Name( node );
+	      if ( at_root && type == XML_READER_TYPE_PROCESSING_INSTRUCTION ){
+		// found a processing instruction on the top level
+		// When this is a style-sheet, it is already handled
+		// otherwise just skip
+		break;
+	      }
+	      string xml_tag = ( type == XML_READER_TYPE_COMMENT )
+		? "_XmlComment" : "PI";
+	      FoliaElement *t;
+	      try {
+		t = AbstractElement::createElement( xml_tag, this );
+	      }
+	      catch ( const exception& e ){
+		throw XmlError( parent,
+				string( "parsing " ) + xml_tag + " failed:\n\t"
+				+ e.what() );
+	      }
+	      if ( debug % DocDbg::PARSING ) {
+		DBG << "created " << t << endl;
+	      }
+	      t = t->parseXml( node );
+	      if ( t ) {
+		if ( debug % DocDbg::PARSING ) {
+		  DBG << "extend " << parent << " met " << t << endl;
+		}
+		parent->append( t );
+	      }
+	    }
+	      break;
+	    case XML_READER_TYPE_ENTITY_REFERENCE:
+	      current.last_tag = TiCC::Name( node );
+	      if ( !at_root ){
+		string txt = TextValue( node );
+		parent->add_child<XmlText>( txt );
+	      }
+	      break;
+	    case XML_READER_TYPE_TEXT:
+	    case XML_READER_TYPE_WHITESPACE:
+	    case XML_READER_TYPE_SIGNIFICANT_WHITESPACE: {
+	      string txt = TiCC::to_string( xmlTextReaderConstValue( reader ) );
+	      if ( !at_root
+		   && ( parent->is_textcontainer()
+			|| parent->is_phoncontainer() ) ){
+		// non empty text is allowed (or even required) here
+		if ( !txt.empty() ) {
+		  parent->add_child<XmlText>( txt );
+		}
+	      }
+	      else {
+		// This MUST be 'empty space', so only spaces and tabs formatting
+		txt = TiCC::trim( txt );
+		if ( !txt.empty() ){
+		  if ( !current.last_tag.empty() ){
+		    string tg = "<" + current.last_tag + ">";
+		    throw XmlError( parent,
+				    "found extra text '" + txt + "' after element "
+				    + tg + ", NOT allowed there." );
+		  }
+		  else {
+		    string tg = "<" + current.tag + ">";
+		    throw XmlError( parent,
+				    "found extra text '" + txt + "' inside element "
+				    + tg + ", NOT allowed there." );
+		  }
+		}
+	      }
+	      current.last_tag = "text";
+	    }
+	      break;
+	    default:
+	      break;
+	    }
+	  }
+	  if ( broken ){
+	    break;
+	  }
+	  ret = skip ? xmlTextReaderNext( reader ) : xmlTextReaderRead( reader );
+	}
+	if ( broken || ret < 0 || !result || !stack.empty() ){
+	  // the XML is broken
+	  cleanup();
+	  return 0;
+	}
+	if ( cnt > 0 ){
+	  throw DocumentError( _source_name, "document is invalid" );
+	}
+	resolveExternals();
+      }
+      catch ( ... ){
+	cleanup();
+	throw;
+      }
+    }
+    catch ( const InconsistentText& e ){
+      throw;
+    }
+    catch ( const DocumentError& e ){
+      throw;
+    }
+    catch ( const XmlError& e ){
+      throw;
+    }
+    catch ( const DeclarationError& e ){
+      throw;
+    }
+    catch ( const ValueError& e ){
+      throw;
+    }
+    catch ( const exception& e ){
+      throw DocumentError( _source_name, e.what() );
+    }
+    return result;
+  }
+
+  bool Document::parse_subtrees( const xmlNode *node ){
+    /// parse the FoLiA element children of node in parallel, when enabled
+    /*!
+      \param node the xmlNode of the body (Text or Speech) of the Document
+      \return true when the children are parsed. They must then be collected
+      in document order, using merge_subtree(). false when parallel parsing
+      is not enabled or not applicable.
+
+      All updates of the Document (the id index, reference counts etc.) are
+      postponed until merge_subtree(), so they are done in document order,
+      and duplicate id's are reported as in a sequential parse.
+    */
+    if ( _parse_threads < 2
+	 || debug != DEBUG_FLAGS::NODEBUG
+	 || _parse_job
+	 || !_parse_jobs.empty() ){
+      return false;
+    }
+    for ( const xmlNode *p = node->children; p; p = p->next ){
+      if ( p->type == XML_ELEMENT_NODE ){
+	string ns = TiCC::getNS( p );
+	if ( ns.empty() || ns == NSFOLIA ){
+	  _parse_jobs.emplace_back();
+	  _parse_jobs.back().node = p;
+	}
+      }
+    }
+    if ( _parse_jobs.size() < 2 ){
+      _parse_jobs.clear();
+      return false;
+    }
+    _merged_jobs = 0;
+    atomic<size_t> next( 0 );
+    auto worker = [this,&next](){
+      size_t i;
+      while ( ( i = next++ ) < _parse_jobs.size() ){
+	run_parse_job( _parse_jobs[i] );
+      }
+    };
+    size_t threads = std::min<size_t>( _parse_threads, _parse_jobs.size() );
+    vector<thread> pool;
+    for ( size_t i=1; i < threads; ++i ){
+      try {
+	pool.emplace_back( worker );
+      }
+      catch ( const system_error& ){
+	// fine, use less threads
+	break;
+      }
+    }
+    worker();
+    for ( auto& t : pool ){
+      t.join();
+    }
+    return true;
+  }
+
+  void Document::run_parse_job( parse_job& job ){
+    /// parse the subtree of job, collecting all Document updates in job
+    job.textclasses = _textclasses;
+    _parse_job = &job;
+    ElementArena::scope nodes( element_arena() );
+    try {
+      ElementType et = stringToElementType( to_string_view( job.node->name ) );
+      job.tree = AbstractElement::createElement( et, this );
+    }
+    catch ( const exception& e ){
+      job.create_error = e.what();
+      _parse_job = 0;
+      return;
+    }
+    try {
+      AbstractElement::parse_scope texts;
+      job.result = job.tree->parseXml( job.node );
+    }
+    catch ( const parallel_fallback& ){
+      job.fallback = true;
+    }
+    catch ( ... ){
+      job.error = current_exception();
+    }
+    _parse_job = 0;
+  }
+
+  void Document::discard_parse_job( parse_job& job ){
+    /// destroy the (partial) result of a parse_job
+    if ( job.tree ){
+      _parse_job = &job;
+      job.tree->destroy();
+      _parse_job = 0;
+      // still referenced nodes are deleted together with the Document
+      delSet.insert( job.deletions.begin(), job.deletions.end() );
+    }
+    job.tree = 0;
+    job.result = 0;
+  }
+
+  FoliaElement *Document::merge_subtree( FoliaElement *parent,
+					 const xmlNode *node ){
+    /// collect a subtree parsed by parse_subtrees() and update the Document
+    /*!
+      \param parent the body node the subtree belongs to
+      \param node the xmlNode of the subtree
+      \return the parsed subtree. Throws like a sequential parse would.
+
+      Must be called for every subtree, in document order. Subtrees that
+      could not be parsed on their own are parsed here again.
+    */
+    if ( _merged_jobs >= _parse_jobs.size()
+	 || _parse_jobs[_merged_jobs].node != node ){
+      throw logic_error( "merge_subtree() called out of order" );
+    }
+    parse_job& job = _parse_jobs[_merged_jobs++];
+    const string tag = TiCC::Name( node );
+    if ( !job.create_error.empty() ){
+      if ( permissive() ){
+	return 0;
+      }
+      throw XmlError( parent,
+		      "parsing <" + tag + "> failed:\n\t" + job.create_error );
+    }
+    if ( job.fallback ){
+      // it needs nodes from other subtrees, or adds declarations
+      discard_parse_job( job );
+      FoliaElement *t = 0;
+      try {
+	t = AbstractElement::createElement( tag, this );
+      }
+      catch ( const exception& e ){
+	throw XmlError( parent,
+			"parsing <" + tag + "> failed:\n\t" + e.what() );
+      }
+      try {
+	return t->parseXml( node );
+      }
+      catch ( ... ){
+	t->destroy();
+	throw;
+      }
+    }
+    for ( const auto& id : job.ids ){
+      if ( job.index.find( id ) != job.index.end()
+	   && sindex.find( id ) != sindex.end() ){
+	discard_parse_job( job );
+	throw DuplicateIDError( id );
+      }
+    }
+    if ( job.error ){
+      discard_parse_job( job );
+      rethrow_exception( job.error );
+    }
+    for ( const auto& id : job.ids ){
+      const auto& it = job.index.find( id );
+      if ( it != job.index.end() ){
+	sindex[id] = it->second;
+      }
+    }
+    for ( const auto& [type,sets] : job.refs ){
+      for ( const auto& [st,cnt] : sets ){
+	if ( cnt > 0 ){
+	  _annotationrefs[type][st] += cnt;
+	}
+	else if ( cnt < 0
+		  && _annotationrefs[type][st] > 0 ){
+	  _annotationrefs[type][st] = std::max( 0,
+						_annotationrefs[type][st] + cnt );
+	}
+      }
+    }
+    delSet.insert( job.deletions.begin(), job.deletions.end() );
+    _externals.insert( _externals.end(),
+		       job.externals.begin(), job.externals.end() );
+    t_offset_validation_buffer.insert( t_offset_validation_buffer.end(),
+				       job.t_offsets.begin(),
+				       job.t_offsets.end() );
+    p_offset_validation_buffer.insert( p_offset_validation_buffer.end(),
+				       job.p_offsets.begin(),
+				       job.p_offsets.end() );
+    _textclasses.insert( job.textclasses.begin(), job.textclasses.end() );
+    _warn_count += job.warn_count;
+    FoliaElement *result = job.result;
+    job.tree = 0;
+    job.result = 0;
+    return result;
+  }
+
+  void Document::discard_subtrees(){
+    /// clean up after parse_subtrees(), also when an error occurred
+    for ( size_t i = _merged_jobs; i < _parse_jobs.size(); ++i ){
+      discard_parse_job( _parse_jobs[i] );
+    }
+    _parse_jobs.clear();
+    _merged_jobs = 0;
+  }
+
   void Document::auto_declare( AnnotationType type,
 			       const string& _setname ) {
     /// create a default declaration for the given AnnotationType
@@ -2189,6 +3517,11 @@ namespace folia {
       \param setname The Set name to add
       \param _args an attribute-value list with additional parameters
     */
+    if ( _parse_job ){
+      // declarations must be added in document order
+      _parse_job->fallback = true;
+      throw parallel_fallback();
+    }
     KWargs args = _args;
     if ( debug % DEBUG_FLAGS::DECLARATIONS ){
       DBG << "declare( " << folia::toString(type) << "," << setname << ", ["
@@ -2652,6 +3985,10 @@ namespace folia {
       if ( st.empty() ){
 	st = default_set(type);
       }
+      if ( _parse_job ){
+	++_parse_job->refs[type][st];
+	return;
+      }
       ++_annotationrefs[type][st];
       // DBG << "increment " << toString(type) << "(" << st << ") to: "
       // 	   << _annotationrefs[type][s] << endl;
@@ -2665,6 +4002,12 @@ namespace folia {
       \param type the AnnotationType
       \param s the setname
     */
+    if ( _parse_job ){
+      if ( type != AnnotationType::NO_ANN ){
+	--_parse_job->refs[type][s];
+      }
+      return;
+    }
     if ( type != AnnotationType::NO_ANN
 	 && _annotationrefs[type][s] > 0 ){
       --_annotationrefs[type][s];
@@ -3641,85 +4984,331 @@ namespace folia {
     return result;
   }
 
-  vector<vector<Word*> > Document::findwords( const Pattern& pat,
-					      const string& args ) const {
-    /// search the Document for vector of Word list matching the Pattern
+  struct unicode_hash {
+    size_t operator()( const UnicodeString& us ) const {
+      return us.hashCode();
+    }
+  };
+
+  class token_table {
+    /// the values of a list of Words, as findwords() compares them, mapped
+    /// on small integers
+  public:
+    token_table( const vector<Word*>&, ElementType );
+    int id( const UnicodeString& ) const;
+    int folded_id( const UnicodeString& ) const;
+    const vector<int>& tokens() const { return _tokens; };
+    const vector<int>& folded() const;
+    const UnicodeString& value( int id ) const { return _values[id]; };
+    size_t size() const { return _values.size(); };
+  private:
+    unordered_map<UnicodeString,int,unicode_hash> _ids;
+    vector<UnicodeString> _values; ///< the distinct values, by id
+    vector<int> _tokens; ///< the id for every Word. -1 when the Word has
+    ///< no value and must be skipped
+    mutable vector<int> _folded; ///< for every id, the id of the first value
+    ///< with the same lowercase form. Filled on first use
+    mutable unordered_map<UnicodeString,int,unicode_hash> _folded_ids; ///<
+    ///< the lowercase forms
+  };
+
+  token_table::token_table( const vector<Word*>& words,
+			    ElementType et ){
+    /// compute the values of all words once
     /*!
-      \param pat The search Pattern
-      \param args additional search options as attribute/value pairs
-      \return a vector of Word list that matched. (if any)
-      supported additional arguments can be 'leftcontext' and 'rightcontext'
+      \param words the Words to search
+      \param et when BASE, use the text of the Words, otherwise the class of
+      their (unique) annotation of this type. Words without exactly one such
+      annotation get no value.
+     */
+    _tokens.reserve( words.size() );
+    for ( const auto& word : words ){
+      UnicodeString value;
+      if ( et == ElementType::BASE ){
+	value = word->text();
+      }
+      else {
+	vector<FoliaElement *> v = word->select( et );
+	if ( v.size() != 1 ){
+	  _tokens.push_back( -1 );
+	  continue;
+	}
+	value = TiCC::UnicodeFromUTF8( v[0]->cls() );
+      }
+      auto it = _ids.emplace( value, static_cast<int>(_ids.size()) );
+      if ( it.second ){
+	_values.push_back( value );
+      }
+      _tokens.push_back( it.first->second );
+    }
+  }
+
+  int token_table::id( const UnicodeString& value ) const {
+    /// return the id of value, or -2 when no Word has this value
+    const auto& it = _ids.find( value );
+    if ( it == _ids.end() ){
+      return -2;
+    }
+    return it->second;
+  }
+
+  const vector<int>& token_table::folded() const {
+    /// return the case insensitive ids of all values
+    if ( _folded.empty() && !_values.empty() ){
+      _folded.reserve( _values.size() );
+      for ( const auto& value : _values ){
+	UnicodeString low = value;
+	low.toLower();
+	auto it = _folded_ids.emplace( low, static_cast<int>(_folded.size()) );
+	_folded.push_back( it.first->second );
+      }
+    }
+    return _folded;
+  }
+
+  int token_table::folded_id( const UnicodeString& low ) const {
+    /// return the case insensitive id of the lowercase value low, or -2 when
+    /// no Word has this value
+    folded();
+    const auto& it = _folded_ids.find( low );
+    if ( it == _folded_ids.end() ){
+      return -2;
+    }
+    return it->second;
+  }
+
+  class token_tables {
+    /// the token_table-s needed by one findwords() call. Patterns that
+    /// search the same annotation share one.
+  public:
+    explicit token_tables( const vector<Word*>& words ): _words( words ){};
+    const token_table& get( ElementType et ){
+      auto it = _tables.find( et );
+      if ( it == _tables.end() ){
+	it = _tables.emplace( et, token_table( _words, et ) ).first;
+      }
+      return it->second;
+    }
+  private:
+    const vector<Word*>& _words;
+    map<ElementType,token_table> _tables;
+  };
+
+  static UnicodeString literal_prefix( const UnicodeString& regex ){
+    /// return a literal string every match of regex must start with
+    /*!
+      \param regex a regular expression in ICU syntax
+      \return the longest literal start of regex, may be empty
+      We are conservative: an alternation anywhere, or an escape or any
+      other special character ends the prefix. A literal followed by a
+      quantifier is optional, so it is not part of the prefix.
     */
-    size_t leftcontext = 0;
-    size_t rightcontext = 0;
-    KWargs kw = getArgs( args );
-    string val = kw["leftcontext"];
-    if ( !val.empty() ){
-      leftcontext = TiCC::stringTo<size_t>(val);
+    static const UnicodeString special = "\\^$.|?*+()[]{}#";
+    if ( regex.indexOf( '|' ) >= 0 ){
+      return "";
     }
-    val = kw["rightcontext"];
-    if ( !val.empty() ){
-      rightcontext = TiCC::stringTo<size_t>(val);
+    int32_t len = 0;
+    while ( len < regex.length()
+	    && special.indexOf( regex[len] ) < 0
+	    && !u_isspace( regex[len] ) ){
+      ++len;
+    }
+    if ( len > 0 && len < regex.length() ){
+      UChar next = regex[len];
+      if ( next == '?' || next == '*' || next == '{' ){
+	--len;
+	if ( len > 0 && U16_IS_LEAD( regex[len-1] ) ){
+	  --len; // don't split a surrogate pair
+	}
+      }
+    }
+    return UnicodeString( regex, 0, len );
+  }
+
+  class compiled_pattern {
+    /// a Pattern translated to the token ids of a token_table
+    /*!
+      Matching then only compares integers, instead of resolving and
+      comparing the text of the same Word again for every start position.
+      The matching rules are exactly those of Pattern::match()
+    */
+  public:
+    compiled_pattern( const Pattern&, token_tables& );
+    vector<vector<Word*> > search( const vector<Word*>&,
+				   size_t, size_t ) const;
+  private:
+    enum class step_kind : unsigned char { LITERAL, ANY, GAP, REGEX };
+    bool step( int, size_t&, int&, bool&, bool& ) const;
+    bool regex_match( size_t, int ) const;
+    const token_table *_table;
+    const vector<int> *_folded; ///< 0 when case sensitive
+    const vector<RegexMatcher*>& _matchers;
+    vector<UnicodeString> _prefixes; ///< the literal prefix of every regular
+    ///< expression
+    mutable vector<vector<signed char>> _regex_results; ///< for every regular
+    ///< expression the outcome per token id: -1 (not tried yet), 0 or 1
+    vector<int> _ids;
+    vector<step_kind> _kinds;
+    int _maxgapsize;
+  };
+
+  compiled_pattern::compiled_pattern( const Pattern& pat,
+				      token_tables& tables ):
+    _folded( 0 ),
+    _matchers( pat.matchers ),
+    _maxgapsize( pat.maxgapsize )
+  {
+    /// compile a Pattern
+    /*!
+      \param pat the Pattern
+      \param tables the tables to take the token values from
+    */
+    _table = &tables.get( pat.matchannotation );
+    if ( !pat.case_sensitive ){
+      _folded = &_table->folded();
+    }
+    for ( size_t i=0; i < pat.sequence.size(); ++i ){
+      const UnicodeString& seq = pat.sequence[i];
+      // the sequence of a case insensitive Pattern is lowercased already
+      _ids.push_back( pat.case_sensitive ? _table->id( seq )
+		      : _table->folded_id( seq ) );
+      UnicodeString prefix;
+      vector<signed char> results;
+      if ( pat.matchers[i] ){
+	_kinds.push_back( step_kind::REGEX );
+	prefix = literal_prefix( pat.matchers[i]->pattern().pattern() );
+	results.resize( _table->size(), -1 );
+      }
+      else if ( seq == "*:1" ){
+	_kinds.push_back( step_kind::ANY );
+      }
+      else if ( seq == "*" ){
+	_kinds.push_back( step_kind::GAP );
+      }
+      else {
+	_kinds.push_back( step_kind::LITERAL );
+      }
+      _prefixes.push_back( prefix );
+      _regex_results.push_back( results );
+    }
+  }
+
+  bool compiled_pattern::regex_match( size_t pos, int token ) const {
+    /// match the regular expression at pos against a token value
+    /*!
+      \param pos the position in the Pattern
+      \param token the id of the value
+      \return true when the whole value matches
+
+      Every distinct value is tried only once. Values that don't start
+      with the literal prefix of the expression can't match, and are
+      rejected without running the matcher.
+    */
+    signed char& result = _regex_results[pos][token];
+    if ( result < 0 ){
+      const UnicodeString& value = _table->value( token );
+      if ( !value.startsWith( _prefixes[pos] ) ){
+	result = 0;
+      }
+      else {
+	RegexMatcher *matcher = _matchers[pos];
+	matcher->reset( value );
+	UErrorCode u_stat = U_ZERO_ERROR;
+	result = matcher->matches( u_stat ) ? 1 : 0;
+      }
+    }
+    return result == 1;
+  }
+
+  bool compiled_pattern::step( int token,
+			       size_t& pos,
+			       int& gap,
+			       bool& done,
+			       bool& flag ) const {
+    /// try to match one token. See Pattern::match() for the parameters
+    if ( _kinds[pos] == step_kind::REGEX ){
+      // regular expressions work on the original value
+      bool ok = regex_match( pos, token );
+      done = ( ++pos >= _ids.size() ) && ok;
+      return ok;
+    }
+    if ( _folded ){
+      token = (*_folded)[token];
+    }
+    if ( _ids[pos] == token || _kinds[pos] == step_kind::ANY ){
+      done = ( ++pos >= _ids.size() );
+      return true;
+    }
+    else if ( _kinds[pos] == step_kind::GAP ){
+      if ( (pos + 1 ) >= _ids.size() ){
+	done = true;
+      }
+      else if ( _ids[pos+1] == token ){
+	flag = ( ++gap < _maxgapsize );
+	if ( !flag ){
+	  pos = pos + gap;
+	  done = ( ++pos >= _ids.size() );
+	}
+	else {
+	  done = true;
+	}
+      }
+      else if ( ++gap == _maxgapsize ){
+	++pos;
+      }
+      else {
+	flag = true;
+      }
+      return true;
     }
+    ++pos;
+    return false;
+  }
+
+  vector<vector<Word*> > compiled_pattern::search( const vector<Word*>& mywords,
+						   size_t leftcontext,
+						   size_t rightcontext ) const {
+    /// find all matches of the pattern in mywords
+    /*!
+      \param mywords the Words of the Document
+      \param leftcontext the number of context Words to add before a match
+      \param rightcontext the number of context Words to add after a match
+      \return a vector of Word list that matched. (if any)
+    */
+    const vector<int>& tokens = _table->tokens();
     vector<vector<Word*> > result;
     vector<Word*> matched;
-    if ( pat.regexp ){
-      throw runtime_error( "regexp not supported yet in patterns" );
-    }
-    vector<Word*> mywords = words();
     for ( size_t startpos =0; startpos < mywords.size(); ++startpos ){
       // loop over all words
-      //    DBG << "outer loop STARTPOS = " << startpos << endl;
       size_t cursor = 0;
       int gap = 0;
       bool goon = true;
       for ( size_t i = startpos; i < mywords.size() && goon ; ++i ){
-	//      DBG << "inner LOOP I = " << i << " myword=" << mywords[i] << endl;
-	UnicodeString value;
-	if ( pat.matchannotation == ElementType::BASE ){
-	  value = mywords[i]->text();
-	}
-	else {
-	  vector<FoliaElement *> v = mywords[i]->select( pat.matchannotation );
-	  if ( v.size() != 1 ){
-	    continue;
-	  }
-	  value = TiCC::UnicodeFromUTF8(v[0]->cls());
+	if ( tokens[i] < 0 ){
+	  continue;
 	}
 	bool done = false;
 	bool flag = false;
-	if ( pat.match( value, cursor, gap, done, flag ) ){
-	  // DBG << "matched, " << (done?"done":"not done")
-	  //      << (flag?" Flagged!":":{") << endl;
+	if ( step( tokens[i], cursor, gap, done, flag ) ){
 	  matched.push_back(mywords[i]);
 	  if ( cursor == 0 ){
 	    startpos = i; // restart search here
 	  }
 	  if ( done ){
-	    vector<Word*> keep = matched;
-	    //	  DBG << "findnodes() tussenresultaat ==> " << matched << endl;
 	    vector<Word*> left_v;
 	    if ( leftcontext > 0 ){
 	      left_v = matched[0]->leftcontext(leftcontext);
-	      //	    DBG << "findnodes() left ==> " << left_v << endl;
 	      copy( matched.begin(), matched.end(), back_inserter(left_v) );
-	      //	    DBG << "findnodes() after copy left_v ==> " << left_v << endl;
 	    }
 	    else {
 	      left_v = matched;
 	    }
 	    if ( rightcontext > 0 ){
 	      vector<Word*> right_v = matched.back()->rightcontext(rightcontext);
-	      //	    DBG << "findnodes() right_v ==> " << right_v << endl;
 	      copy( right_v.begin(), right_v.end(), back_inserter(left_v) );
-	      //	    DBG << "findnodes() right_v na copy ==> " << right_v << endl;
 	    }
-	    //	  DBG << "findnodes() tussenresultaat 2 ==> " << left_v << endl;
 	    result.push_back(left_v);
-	    if ( flag ){
-	      matched = keep;
-	    }
-	    else {
+	    if ( !flag ){
 	      cursor = 0;
 	      matched.clear();
 	      goon = false;
@@ -3733,10 +5322,44 @@ namespace folia {
 	}
       }
     }
-    //  DBG << "findnodes() result ==> " << result << endl;
     return result;
   }
 
+  static void context_args( const string& args,
+			    size_t& leftcontext,
+			    size_t& rightcontext ){
+    /// extract the 'leftcontext' and 'rightcontext' values from args
+    leftcontext = 0;
+    rightcontext = 0;
+    KWargs kw = getArgs( args );
+    string val = kw["leftcontext"];
+    if ( !val.empty() ){
+      leftcontext = TiCC::stringTo<size_t>(val);
+    }
+    val = kw["rightcontext"];
+    if ( !val.empty() ){
+      rightcontext = TiCC::stringTo<size_t>(val);
+    }
+  }
+
+  vector<vector<Word*> > Document::findwords( const Pattern& pat,
+					      const string& args ) const {
+    /// search the Document for vector of Word list matching the Pattern
+    /*!
+      \param pat The search Pattern
+      \param args additional search options as attribute/value pairs
+      \return a vector of Word list that matched. (if any)
+      supported additional arguments can be 'leftcontext' and 'rightcontext'
+    */
+    size_t leftcontext;
+    size_t rightcontext;
+    context_args( args, leftcontext, rightcontext );
+    vector<Word*> mywords = words();
+    token_tables tables( mywords );
+    compiled_pattern cp( pat, tables );
+    return cp.search( mywords, leftcontext, rightcontext );
+  }
+
   vector<vector<Word*> > Document::findwords( list<Pattern>& pats,
 					      const string& args ) const {
     /// search the Document for vector of Word list matching one of the Pattern
@@ -3782,9 +5405,19 @@ namespace folia {
 	it.unsetwild();
       }
     }
-    vector<vector<Word*> > result;
+    size_t leftcontext;
+    size_t rightcontext;
+    context_args( args, leftcontext, rightcontext );
+    vector<Word*> mywords = words();
+    token_tables tables( mywords );
+    vector<compiled_pattern> compiled;
     for ( const auto& it : pats ){
-      vector<vector<Word*> > res = findwords( it, args );
+      compiled.emplace_back( it, tables );
+    }
+    vector<vector<Word*> > result;
+    for ( const auto& cp : compiled ){
+      vector<vector<Word*> > res = cp.search( mywords,
+					      leftcontext, rightcontext );
       if ( result.empty() ){
 	result = res;
       }
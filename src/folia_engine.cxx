@@ -304,40 +304,41 @@ namespace folia {
     return result;
   }
 
-  xmlTextReader *create_text_reader( const string& buf ){
+  xmlTextReader *create_text_reader( const string& buf, string& buffer ){
     /// create a new xmlTextRead on a buffer
     /*!
       \param buf the input buffer.
       The buffer may contain a complete (FoLiA-) XML document as a string
-      OR a filename denoting such a document, which may be .bz2 and .gz
-      encoded
+      OR a filename denoting such a document, which may be compressed.
+      (gzip, bzip2, xz or zstd, detected by content)
+      \param buffer storage for decompressed .bz2 input, when we cannot
+      decompress while parsing. The reader parses it in place, so it must
+      outlive the reader.
     */
     if ( TiCC::match_front( buf, "<?xml " ) ){
       return xmlReaderForMemory( buf.c_str(), buf.size(),
 				 "input_buffer", 0, XML_PARSER_OPTIONS );
     }
-    else if ( TiCC::match_back( buf, ".bz2" ) ){
-      string buffer = TiCC::bz2ReadFile( buf );
-      if ( buffer.empty() ){
-	throw runtime_error( "folia::Engine(), empty file? (" + buf
-			      + ")" );
+    Compression comp = detect_compression( buf );
+    if ( comp != Compression::NONE ){
+      if ( has_decompressor( comp ) ){
+	return decompress_reader( create_decompressor( buf, comp ) );
       }
-      //
-      // next step fails for unclear reasons
-      // so we use an intermediate file. Which works, but is clumsy
-      //
-      // return xmlReaderForMemory( buffer.c_str(), buffer.size()+1,
-      //  				 buf.c_str(), 0, XML_PARSER_OPTIONS );
-      TiCC::tmp_stream ts( "folia" );
-      string tmp_file = ts.tmp_name();
-      ofstream& os = ts.os();
-      os << buffer << endl;
-      ts.close();
-      xmlTextReader *result
-	= xmlReaderForFile( tmp_file.c_str(), 0, XML_PARSER_OPTIONS );
-      return result;
-    }
-    // libxml2 can handle .xml and .xml.gz
+      else if ( comp == Compression::BZIP2 ){
+	buffer = TiCC::bz2ReadFile( buf );
+	if ( buffer.empty() ){
+	  throw runtime_error( "folia::Engine(), empty file? (" + buf
+			       + ")" );
+	}
+	return xmlReaderForMemory( buffer.c_str(), buffer.size(),
+				   buf.c_str(), 0, XML_PARSER_OPTIONS );
+      }
+      else if ( comp == Compression::ZSTD ){
+	throw runtime_error( "folia::Engine(), no support for zstd "
+			     "compressed input (" + buf + ")" );
+      }
+    }
+    // libxml2 can handle .xml (and .xml.gz)
     return xmlReaderForFile( buf.c_str(), 0, XML_PARSER_OPTIONS );
   }
 
@@ -427,7 +428,7 @@ namespace folia {
       _out_name = out_name;
     }
     _out_doc->_source_name = file_name;
-    _reader = create_text_reader( file_name );
+    _reader = create_text_reader( file_name, _input_buffer );
     if ( _reader == 0 ){
       _ok = false;
       throw( runtime_error( "folia::Engine(), init failed on '" + file_name
@@ -474,6 +475,7 @@ namespace folia {
 	  if ( !id.empty() ){
 	    FoliaElement *root = new FoLiA( in_args, _out_doc );
 	    _out_doc->foliadoc = root;
+	    _out_doc->invalidate_index();
 	  }
 	  else {
 	    _ok = false;
@@ -637,12 +639,14 @@ namespace folia {
       ret = xmlTextReaderRead(_reader);
     }
     if ( xmlTextReaderReadState(_reader) < 0 ){
+      check_decompress_error();
       throw runtime_error( "get_node() reading failed" );
     }
     if ( ret == 0 ){
       if ( _debug ){
 	DBG << "get node name, DONE" << endl;
       }
+      check_decompress_error();
       _done = true;
       return 0;
     }
@@ -698,6 +702,7 @@ namespace folia {
       }
       ret = xmlTextReaderRead(_reader);
     }
+    check_decompress_error();
     _done = true;
     return 0;
   }
@@ -709,7 +714,8 @@ namespace folia {
       buffer containing a complete XML file too
       \return the light-weight tree with the relevant nodes
     */
-    xmlTextReader *cur_reader = create_text_reader( in_file );
+    string buffer;
+    xmlTextReader *cur_reader = create_text_reader( in_file, buffer );
     if ( xmlTextReaderReadState(cur_reader) < 0 ){
       throw runtime_error( "create_simple_tree() init failed" );
     }
@@ -1396,6 +1402,7 @@ namespace folia {
       if ( _debug ){
 	DBG << "next_text_parent(), DONE" << endl;
       }
+      check_decompress_error();
       _done = true;
       return 0;
     }
@@ -1457,6 +1464,7 @@ namespace folia {
       }
       ret = xmlTextReaderRead(_reader);
     }
+    check_decompress_error();
     _done = true;
     return 0;
   }
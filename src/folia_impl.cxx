@@ -34,15 +34,23 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <array>
+#include <bitset>
+#include <string_view>
 #include <algorithm>
 #include <type_traits>
 #include <stdexcept>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
+#include "unicode/utf8.h"
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/StringOps.h"
 #include "ticcutils/XMLtools.h"
 #include "ticcutils/Unicode.h"
 #include "libfolia/folia.h"
 #include "libfolia/folia_properties.h"
+#include "libfolia/folia_simd.h"
 #include "config.h"
 
 using namespace std;
@@ -186,7 +194,77 @@ namespace folia {
       \return true when the parameter is an AbstractStructureElement
       or a derivative of an AbstractStructureElement
     */
-    return dynamic_cast<const AbstractStructureElement*>( el ) != 0;
+    return el->is_a( ElementType::AbstractStructureElement_t );
+  }
+
+  template <typename T>
+  static void add_class_bit( const FoliaElement *el,
+			     ElementType et,
+			     bitset<ELEMENT_TYPE_COUNT>& row ){
+    /// set the bit for et in row, when el is derived from T
+    if ( dynamic_cast<const T*>( el ) ){
+      row.set( static_cast<size_t>(et) );
+    }
+  }
+
+  static vector<bitset<ELEMENT_TYPE_COUNT>> build_class_matrix(){
+    /// for every ElementType, collect the ElementTypes of its C++ classes
+    /*!
+      This follows the C++ class hierarchy, so it agrees with
+      FoliaElement::isSubClass(). For some types that differs from
+      is_subtype(). E.g. in C++ a Morpheme is an AbstractStructureElement.
+      No concrete class derives from another one, so only the
+      abstract classes are tested.
+    */
+    vector<bitset<ELEMENT_TYPE_COUNT>> matrix( ELEMENT_TYPE_COUNT );
+    for ( ElementType et = ElementType::BASE;
+	  et < ElementType::LastElement;
+	  ++et ){
+      auto& row = matrix[static_cast<size_t>(et)];
+      row.set( static_cast<size_t>(et) );
+      FoliaElement *el = 0;
+      try {
+	el = FoliaElement::createElement( et );
+      }
+      catch ( const ValueError& ){
+	// an abstract ElementType
+	continue;
+      }
+      add_class_bit<AbstractFeature>( el, ElementType::AbstractFeature_t, row );
+      add_class_bit<AbstractWord>( el, ElementType::AbstractWord_t, row );
+      add_class_bit<AbstractAnnotationLayer>( el, ElementType::AbstractAnnotationLayer_t, row );
+      add_class_bit<AbstractContentAnnotation>( el, ElementType::AbstractContentAnnotation_t, row );
+      add_class_bit<AbstractCorrectionChild>( el, ElementType::AbstractCorrectionChild_t, row );
+      add_class_bit<AbstractHigherOrderAnnotation>( el, ElementType::AbstractHigherOrderAnnotation_t, row );
+      add_class_bit<AbstractInlineAnnotation>( el, ElementType::AbstractInlineAnnotation_t, row );
+      add_class_bit<AbstractSpanAnnotation>( el, ElementType::AbstractSpanAnnotation_t, row );
+      add_class_bit<AbstractSpanRole>( el, ElementType::AbstractSpanRole_t, row );
+      add_class_bit<AbstractStructureElement>( el, ElementType::AbstractStructureElement_t, row );
+      add_class_bit<AbstractSubtokenAnnotation>( el, ElementType::AbstractSubtokenAnnotation_t, row );
+      add_class_bit<AbstractTextMarkup>( el, ElementType::AbstractTextMarkup_t, row );
+      destroy( el );
+    }
+    return matrix;
+  }
+
+  bool FoliaElement::is_a( ElementType et ) const {
+    /// test if this element is of type et, or derived from it
+    /*!
+      \param et the ElementType to test
+      \return true when this is an et or an et is a base class of this.
+
+      The answer is a lookup in a matrix of bits, one row per ElementType,
+      built once by build_class_matrix(). So it agrees with isSubClass<T>(),
+      but needs no dynamic_cast.
+    */
+    static const vector<bitset<ELEMENT_TYPE_COUNT>> matrix
+      = build_class_matrix();
+    ElementType my_et = element_id();
+    if ( my_et >= ElementType::LastElement
+	 || et >= ElementType::LastElement ){
+      return my_et == et;
+    }
+    return matrix[static_cast<size_t>(my_et)].test( static_cast<size_t>(et) );
   }
 
   const string AllowXlink::href() const {
@@ -202,6 +280,69 @@ namespace folia {
     return "";
   }
 
+  /// the attributes that most nodes never use
+  /*!
+    These are kept out of AbstractElement, and only allocated when one of
+    them gets a value.
+  */
+  struct AbstractElement::rare_attributes {
+    rare_attributes(): confidence(-1){};
+    std::string n;
+    std::string begintime;
+    std::string endtime;
+    std::string speaker;
+    std::string metadata;
+    std::string src;
+    std::string tags;
+    double confidence;
+  };
+
+  AbstractElement::rare_attributes& AbstractElement::rare(){
+    /// return the rare attributes record, allocating it when needed
+    if ( !_rare ){
+      _rare = new rare_attributes();
+    }
+    return *_rare;
+  }
+
+  /// the text() results of one thread, remembered while parsing
+  /*!
+    see AbstractElement::parse_scope
+  */
+  struct AbstractElement::text_memo {
+    struct entry {
+      std::string cls;
+      TEXT_FLAGS flags;
+      CORRECTION_HANDLING correction;
+      bool preserve;              ///< the node had xml:space="preserve"
+      UnicodeString text;
+      std::exception_ptr error;   ///< the NoSuchText thrown, if any
+    };
+    std::unordered_map<const FoliaElement*,std::vector<entry>> texts;
+  };
+
+  thread_local AbstractElement::text_memo *AbstractElement::_parse_texts = 0;
+
+  AbstractElement::parse_scope::parse_scope():
+    /// start remembering the text() results of this thread
+    /*!
+     * nested scopes share the memo of the outermost one
+     */
+    _owner( _parse_texts == 0 )
+  {
+    if ( _owner ){
+      _parse_texts = new text_memo();
+    }
+  }
+
+  AbstractElement::parse_scope::~parse_scope(){
+    /// forget all text() results, when this is the outermost scope
+    if ( _owner ){
+      delete _parse_texts;
+      _parse_texts = 0;
+    }
+  }
+
   const string AbstractElement::set_tag( const string& t ) {
     /// set a value for the _tags attribute
     /*!
@@ -214,8 +355,10 @@ namespace folia {
       throw ValueError( this,
 			"settag() is not supported for " + classname() );
     }
-    string r = _tags;
-    _tags = t;
+    string r = tag();
+    if ( _rare || !t.empty() ){
+      rare().tags = t;
+    }
     return r;
   }
 
@@ -265,6 +408,35 @@ namespace folia {
 	 << " address=" << reinterpret_cast<const void*>(this) << endl;
   }
 
+  void *FoliaElement::operator new( size_t size ){
+    /// allocate memory for a new FoliaElement
+    /*!
+      \param size the number of bytes needed
+      When an ElementArena is active on this thread, the memory is taken
+      from that arena, otherwise from the heap.
+    */
+    ElementArena *arena = ElementArena::current();
+    if ( arena ){
+      return arena->allocate( size );
+    }
+    return ::operator new( size );
+  }
+
+  void FoliaElement::operator delete( void *p ){
+    /// release the memory of a FoliaElement
+    /*!
+      \param p the memory to release.
+      Nodes are normally freed using destroy(), which doesn't come here.
+      This is only used when a constructor throws, while the arena that
+      handed out the memory is still active on this thread. Memory in that
+      arena is left alone: it is released together with the arena.
+    */
+    ElementArena *arena = ElementArena::current();
+    if ( !arena || !arena->owns( p ) ){
+      ::operator delete( p );
+    }
+  }
+
   //  #define DE_AND_CONSTRUCT_DEBUG
 
   AbstractElement::AbstractElement( const properties& p, Document *d ) :
@@ -279,9 +451,9 @@ namespace folia {
     _space(true),
     _annotator_type(AnnotatorType::UNDEFINED),
     _refcount(0),
-    _line_no(-1),
-    _confidence(-1),
     _preserve_spaces(SPACE_FLAGS::UNSET),
+    _line_no(-1),
+    _rare(0),
     _props(p)
   {
     if ( d && d->debug % DocDbg::MEMORY ){
@@ -305,6 +477,73 @@ namespace folia {
 #ifdef DE_AND_CONSTRUCT_DEBUG
     dbg( "really delete" );
 #endif
+    if ( _parse_texts ){
+      _parse_texts->texts.erase( this );
+    }
+    if ( _mydoc && _mydoc->has_text_caches() ){
+      // don't let a new node at the same address find our texts
+      lock_guard<mutex> lock( _mydoc->text_cache_mutex() );
+      _mydoc->text_caches().erase( this );
+    }
+    delete _rare;
+  }
+
+  const string& AbstractElement::tag() const {
+    /// return the value of the tag attribute
+    return _rare ? _rare->tags : EMPTY_STRING;
+  }
+
+  const string& AbstractElement::n() const {
+    /// return the value of the n attribute
+    return _rare ? _rare->n : EMPTY_STRING;
+  }
+
+  void AbstractElement::set_n( const string& n ){
+    /// set the n attribute
+    if ( _rare || !n.empty() ){
+      rare().n = n;
+    }
+  }
+
+  const string& AbstractElement::begintime() const {
+    /// return the value of the begintime attribute
+    return _rare ? _rare->begintime : EMPTY_STRING;
+  }
+
+  void AbstractElement::set_begintime( const string& bt ){
+    /// set the begintime attribute
+    if ( _rare || !bt.empty() ){
+      rare().begintime = bt;
+    }
+  }
+
+  const string& AbstractElement::endtime() const {
+    /// return the value of the endtime attribute
+    return _rare ? _rare->endtime : EMPTY_STRING;
+  }
+
+  void AbstractElement::set_endtime( const string& et ){
+    /// set the endtime attribute
+    if ( _rare || !et.empty() ){
+      rare().endtime = et;
+    }
+  }
+
+  const string& AbstractElement::src() const {
+    /// return the value of the src attribute
+    return _rare ? _rare->src : EMPTY_STRING;
+  }
+
+  double AbstractElement::confidence() const {
+    /// return the confidence value. -1 means: not set
+    return _rare ? _rare->confidence : -1;
+  }
+
+  void AbstractElement::set_confidence( double d ){
+    /// set the confidence value. -1 means: not set
+    if ( _rare || d != -1 ){
+      rare().confidence = d;
+    }
   }
 
   void AbstractElement::destroy( ) {
@@ -357,7 +596,26 @@ namespace folia {
       DBG << "\t id=" << _id << " class= " << cls()
 	   << " datasize= " << _data.size() << endl;
     }
-    delete this;
+    if ( doc() ){
+      doc()->forget_detached( this );
+    }
+    free_memory();
+  }
+
+  void AbstractElement::free_memory(){
+    /// run the destructor and give the memory back to where it came from
+    /*!
+      That is the heap, or an ElementArena. Memory in an arena of the
+      Document is released together with that arena. When the Document is
+      already gone, the arena is told that one of its nodes is freed.
+    */
+    const Document *d = _mydoc;
+    void *mem = dynamic_cast<void*>( this );
+    this->~AbstractElement();
+    if ( d ? d->arena_node( mem ) : ElementArena::unpin( mem ) ){
+      return;
+    }
+    ::operator delete( mem );
   }
 
   void destroy( FoliaElement *el ){
@@ -389,7 +647,7 @@ namespace folia {
      * the anntotation-type, when de document allows this.
      */
 
-    if ( isSubClass<AbstractCorrectionChild>() ){
+    if ( is_a( ElementType::AbstractCorrectionChild_t ) ){
       return;
     }
 
@@ -445,7 +703,7 @@ namespace folia {
 	  }
 	}
 	else if ( _set.empty()
-		  && !isSubClass<AbstractAnnotationLayer>()
+		  && !is_a( ElementType::AbstractAnnotationLayer_t )
 		  && !doc()->declared( annotation_type(), "None" ) ){
 	  if ( _mydoc->autodeclare() ){
 	    _mydoc->auto_declare( annotation_type(), _set );
@@ -619,6 +877,103 @@ namespace folia {
     }
   }
 
+  /// the attributes that AbstractElement::setAttributes() handles itself
+  enum class ATT_KEY : signed char {
+    GENERATE_ID, XML_ID, OLD_ID, SET, CLASS, PROCESSOR, ANNOTATOR,
+    ANNOTATORTYPE, CONFIDENCE, N, DATETIME, BEGINTIME, ENDTIME, SRC, TAG,
+    SPACE, METADATA, SPEAKER, TEXTCLASS, AUTH, TYPEGROUP,
+    UNKNOWN
+  };
+
+  const size_t ATT_KEY_COUNT = static_cast<size_t>(ATT_KEY::UNKNOWN);
+
+  /// the attribute names, in the order of ATT_KEY
+  constexpr string_view att_names[ATT_KEY_COUNT] = {
+    "generate_id", "xml:id", "_id", "set", "class", "processor", "annotator",
+    "annotatortype", "confidence", "n", "datetime", "begintime", "endtime",
+    "src", "tag", "space", "metadata", "speaker", "textclass", "auth",
+    "typegroup"
+  };
+
+  const size_t ATT_HASH_SIZE = 64;
+
+  constexpr size_t att_hash( string_view name ){
+    /// a perfect hash for the names in att_names
+    return ( static_cast<unsigned char>(name.front())
+	     + 31 * static_cast<unsigned char>(name.back()) ) % ATT_HASH_SIZE;
+  }
+
+  constexpr array<signed char,ATT_HASH_SIZE> make_att_table(){
+    /// build the hash table. Fails to compile when the hash isn't perfect
+    array<signed char,ATT_HASH_SIZE> table{};
+    for ( size_t i=0; i < ATT_HASH_SIZE; ++i ){
+      table[i] = -1;
+    }
+    for ( size_t i=0; i < ATT_KEY_COUNT; ++i ){
+      size_t h = att_hash( att_names[i] );
+      if ( table[h] != -1 ){
+	throw logic_error( "collision in att_hash()" );
+      }
+      table[h] = static_cast<signed char>(i);
+    }
+    return table;
+  }
+
+  constexpr array<signed char,ATT_HASH_SIZE> att_table = make_att_table();
+
+  static ATT_KEY attribute_key( const string& name ){
+    /// map an attribute name on an ATT_KEY, using one hash and one compare
+    if ( name.empty() ){
+      return ATT_KEY::UNKNOWN;
+    }
+    int index = att_table[att_hash( name )];
+    if ( index >= 0
+	 && att_names[index] == name ){
+      return static_cast<ATT_KEY>(index);
+    }
+    return ATT_KEY::UNKNOWN;
+  }
+
+  /// the values of the attributes that setAttributes() handles itself
+  /*!
+    These are moved out of the KWargs in one pass. Values that are not
+    extracted are put back by restore(), so they are rejected later on just
+    like other unknown attributes.
+  */
+  class attribute_values {
+  public:
+    explicit attribute_values( KWargs& kwargs ){
+      auto it = kwargs.begin();
+      while ( it != kwargs.end() ){
+	ATT_KEY key = attribute_key( it->first );
+	if ( key == ATT_KEY::UNKNOWN ){
+	  ++it;
+	}
+	else {
+	  size_t index = static_cast<size_t>(key);
+	  _values[index] = std::move( it->second );
+	  _present[index] = true;
+	  it = kwargs.erase( it );
+	}
+      }
+    }
+    string extract( ATT_KEY key ){
+      size_t index = static_cast<size_t>(key);
+      _present[index] = false;
+      return std::move( _values[index] );
+    }
+    void restore( KWargs& kwargs ){
+      for ( size_t i=0; i < ATT_KEY_COUNT; ++i ){
+	if ( _present[i] ){
+	  kwargs[string(att_names[i])] = _values[i];
+	}
+      }
+    }
+  private:
+    string _values[ATT_KEY_COUNT];
+    bool _present[ATT_KEY_COUNT] = {};
+  };
+
   void AbstractElement::setAttributes( KWargs& kwargs ) {
     /// set the objects attributes given a set of Key-Value pairs.
     /*!
@@ -666,7 +1021,8 @@ namespace folia {
 	// DBG << "AUTH : " << _auth << endl;
       }
     }
-    string val = kwargs.extract( "generate_id" );
+    attribute_values atts( kwargs );
+    string val = atts.extract( ATT_KEY::GENERATE_ID );
     if ( !val.empty() ) {
       if ( !doc() ) {
 	throw runtime_error( "can't generate an ID without a doc" );
@@ -698,9 +1054,9 @@ namespace folia {
       }
     }
     else {
-      val = kwargs.extract( "xml:id" );
+      val = atts.extract( ATT_KEY::XML_ID );
       if ( val.empty() ) {
-	val = kwargs.extract( "_id" ); // for backward compatibility
+	val = atts.extract( ATT_KEY::OLD_ID ); // for backward compatibility
       }
       if ( !val.empty() ) {
 	if ( ! (supported % Attrib::ID ) ) {
@@ -728,7 +1084,7 @@ namespace folia {
     }
 
     _set.clear();
-    val = kwargs.extract( "set" );
+    val = atts.extract( ATT_KEY::SET );
     if ( !val.empty() ) {
       if ( !doc() ) {
 	throw ValueError( this,
@@ -754,7 +1110,7 @@ namespace folia {
     check_set_declaration();
 
     _class.clear();
-    val = kwargs.extract( "class" );
+    val = atts.extract( ATT_KEY::CLASS );
     if ( !val.empty() ) {
       if ( !(supported % Attrib::CLASS ) ) {
 	throw ValueError( this,
@@ -790,7 +1146,7 @@ namespace folia {
       }
     }
 
-    val = kwargs.extract( "processor" );
+    val = atts.extract( ATT_KEY::PROCESSOR );
     if ( !val.empty() ){
       if ( !( supported % Attrib::ANNOTATOR ) ){
 	throw ValueError( this,
@@ -821,7 +1177,7 @@ namespace folia {
     }
 
     _annotator.clear();
-    val = kwargs.extract( "annotator" );
+    val = atts.extract( ATT_KEY::ANNOTATOR );
     if ( !val.empty() ) {
       if ( !(supported % Attrib::ANNOTATOR) ) {
 	throw ValueError( this,
@@ -833,7 +1189,7 @@ namespace folia {
 	     && val != doc()->get_processor(_processor_id)->name() ){
 	  if ( doc() && doc()->autodeclare() ){
 	    annotator2processor( val,
-				 kwargs.extract( "annotatortype" ) );
+				 atts.extract( ATT_KEY::ANNOTATORTYPE ) );
 	  }
 	  else {
 	    throw DeclarationError( this,
@@ -858,7 +1214,7 @@ namespace folia {
     }
 
     _annotator_type = AnnotatorType::UNDEFINED;
-    val = kwargs.extract( "annotatortype" );
+    val = atts.extract( ATT_KEY::ANNOTATORTYPE );
     if ( !val.empty() ) {
       if ( ! (supported % Attrib::ANNOTATOR ) ) {
 	throw ValueError( this,
@@ -882,8 +1238,8 @@ namespace folia {
       }
     }
 
-    _confidence = -1;
-    val = kwargs.extract( "confidence" );
+    set_confidence( -1 );
+    val = atts.extract( ATT_KEY::CONFIDENCE );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::CONFIDENCE ) ) {
 	throw ValueError( this,
@@ -891,13 +1247,14 @@ namespace folia {
       }
       else {
 	try {
-	  _confidence = stringTo<double>(val);
-	  if ( _confidence < 0 || _confidence > 1.0 ){
+	  double confidence = stringTo<double>(val);
+	  if ( confidence < 0 || confidence > 1.0 ){
 	    throw ValueError( this,
 			      "Confidence must be a floating point number "
 			      "between 0 and 1, got "
-			      + TiCC::toString(_confidence) );
+			      + TiCC::toString(confidence) );
 	  }
+	  set_confidence( confidence );
 	}
 	catch (...) {
 	  throw ValueError( this,
@@ -907,19 +1264,19 @@ namespace folia {
       }
     }
 
-    _n = "";
-    val = kwargs.extract( "n" );
+    set_n( "" );
+    val = atts.extract( ATT_KEY::N );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::N) ) {
 	throw ValueError( this,
 			  "N attribute is not supported for " + classname() );
       }
       else {
-	_n = val;
+	set_n( val );
       }
     }
     _datetime.clear();
-    val = kwargs.extract( "datetime" );
+    val = atts.extract( ATT_KEY::DATETIME );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::DATETIME ) ) {
 	throw ValueError( this,
@@ -943,7 +1300,7 @@ namespace folia {
 	_datetime = def;
       }
     }
-    val = kwargs.extract( "begintime" );
+    val = atts.extract( ATT_KEY::BEGINTIME );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::BEGINTIME) ) {
 	throw ValueError( this,
@@ -957,13 +1314,13 @@ namespace folia {
 			    "invalid begintime, must be in HH:MM:SS.mmm "
 			    "format: " + val );
 	}
-	_begintime = time;
+	set_begintime( time );
       }
     }
     else {
-      _begintime.clear();
+      set_begintime( "" );
     }
-    val = kwargs.extract( "endtime" );
+    val = atts.extract( ATT_KEY::ENDTIME );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::ENDTIME) ) {
 	throw ValueError( this,
@@ -976,44 +1333,44 @@ namespace folia {
 	  throw ValueError( this, "invalid endtime, must be in HH:MM:SS.mmm "
 			    "format: " + val );
 	}
-	_endtime = time;
+	set_endtime( time );
       }
     }
     else {
-      _endtime.clear();
+      set_endtime( "" );
     }
 
-    val = kwargs.extract( "src" );
+    val = atts.extract( ATT_KEY::SRC );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::SRC) ) {
 	throw ValueError( this,
 			  "src attribute is not supported for " + classname() );
       }
       else {
-	_src = val;
+	rare().src = val;
       }
     }
-    else {
-      _src.clear();
+    else if ( _rare ){
+      _rare->src.clear();
     }
-    val = kwargs.extract( "tag" );
+    val = atts.extract( ATT_KEY::TAG );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::TAG) ) {
 	throw ValueError( this,
 			  "tag attribute is not supported for " + classname() );
       }
       else {
-	_tags = val;
+	rare().tags = val;
       }
     }
-    else {
-      _tags.clear();
+    else if ( _rare ){
+      _rare->tags.clear();
     }
 
     if ( supported % Attrib::SPACE  ){
       _space = true;
     }
-    val = kwargs.extract( "space" );
+    val = atts.extract( ATT_KEY::SPACE );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::SPACE ) ){
 	throw ValueError( this,
@@ -1035,7 +1392,7 @@ namespace folia {
       }
     }
 
-    val = kwargs.extract( "metadata" );
+    val = atts.extract( ATT_KEY::METADATA );
     if ( !val.empty() ) {
       if ( !( supported % Attrib::METADATA) ) {
 	throw ValueError( this,
@@ -1043,17 +1400,17 @@ namespace folia {
 			  + classname() );
       }
       else {
-	_metadata = val;
-	if ( doc() && doc()->get_submetadata( _metadata ) == 0 ){
+	if ( doc() && doc()->get_submetadata( val ) == 0 ){
 	  throw ValueError( this,
-			    "No such metadata defined: " + _metadata );
+			    "No such metadata defined: " + val );
 	}
+	rare().metadata = val;
       }
     }
-    else {
-      _metadata.clear();
+    else if ( _rare ){
+      _rare->metadata.clear();
     }
-    val = kwargs.extract( "speaker" );
+    val = atts.extract( ATT_KEY::SPEAKER );
     if ( !val.empty() ) {
       if ( !(supported % Attrib::SPEAKER) ) {
 	throw ValueError( this,
@@ -1061,14 +1418,14 @@ namespace folia {
 			  + classname() );
       }
       else {
-	_speaker = val;
+	rare().speaker = val;
       }
     }
-    else {
-      _speaker.clear();
+    else if ( _rare ){
+      _rare->speaker.clear();
     }
 
-    val = kwargs.extract( "textclass" );
+    val = atts.extract( ATT_KEY::TEXTCLASS );
     if ( !val.empty() ) {
       if ( !(supported % Attrib::TEXTCLASS) ) {
 	throw ValueError( this,
@@ -1083,7 +1440,7 @@ namespace folia {
       _textclass = "current";
     }
 
-    val = kwargs.extract( "auth" );
+    val = atts.extract( ATT_KEY::AUTH );
     if ( !val.empty() ){
       _auth = stringTo<bool>( val );
     }
@@ -1096,9 +1453,13 @@ namespace folia {
 	  throw;
 	}
       }
-      doc()->setdebug( doc_dbg );
+      if ( doc()->debug != doc_dbg ){
+	// restore it, when switched off above
+	doc()->setdebug( doc_dbg );
+      }
     }
-    kwargs.erase("typegroup"); //this is used in explicit form only, we can safely discard it
+    atts.extract( ATT_KEY::TYPEGROUP ); //this is used in explicit form only, we can safely discard it
+    atts.restore( kwargs );
     addFeatureNodes( kwargs );
   }
 
@@ -1201,37 +1562,37 @@ namespace folia {
   }
 
   void AbstractElement::set_typegroup( KWargs& attribs ) const {
-    if ( isSubClass<AbstractStructureElement>() ){
+    if ( is_a( ElementType::AbstractStructureElement_t ) ){
       attribs.add("typegroup","structure");
     }
-    else if ( isSubClass<AbstractFeature>() ){
+    else if ( is_a( ElementType::AbstractFeature_t ) ){
       attribs.add("typegroup","feature");
     }
-    else if ( isSubClass<AbstractInlineAnnotation>() ){
+    else if ( is_a( ElementType::AbstractInlineAnnotation_t ) ){
       attribs.add("typegroup","inline");
     }
-    else if ( isSubClass<AbstractHigherOrderAnnotation>() ){
+    else if ( is_a( ElementType::AbstractHigherOrderAnnotation_t ) ){
       attribs.add("typegroup","higherorder");
     }
-    else if ( isSubClass<AbstractSpanRole>() ){
+    else if ( is_a( ElementType::AbstractSpanRole_t ) ){
       attribs.add("typegroup","spanrole");
     }
-    else if ( isSubClass<AbstractSpanAnnotation>() ){
+    else if ( is_a( ElementType::AbstractSpanAnnotation_t ) ){
       attribs.add("typegroup","span");
     }
-    else if ( isSubClass<AbstractTextMarkup>() ){
+    else if ( is_a( ElementType::AbstractTextMarkup_t ) ){
       attribs.add("typegroup","textmarkup");
     }
-    else if ( isSubClass<AbstractContentAnnotation>() ){
+    else if ( is_a( ElementType::AbstractContentAnnotation_t ) ){
       attribs.add("typegroup","content");
     }
-    else if ( isSubClass<AbstractAnnotationLayer>() ){
+    else if ( is_a( ElementType::AbstractAnnotationLayer_t ) ){
       attribs.add("typegroup","layer");
     }
-    else if ( isSubClass<AbstractSubtokenAnnotation>() ){
+    else if ( is_a( ElementType::AbstractSubtokenAnnotation_t ) ){
       attribs.add("typegroup","subtoken");
     }
-    else if ( isSubClass<AbstractCorrectionChild>() ){
+    else if ( is_a( ElementType::AbstractCorrectionChild_t ) ){
       attribs.add("typegroup","correctionchild");
     }
     else {
@@ -1325,22 +1686,24 @@ namespace folia {
 	 _datetime != doc()->default_datetime( annotation_type(), _set ) ) {
       attribs.add("datetime",_datetime);
     }
-    attribs.add("begintime",_begintime);
-    attribs.add("endtime",_endtime);
-    attribs.add("src",_src);
-    attribs.add("tag",_tags);
-    attribs.add("metadata",_metadata);
-    attribs.add("speaker",_speaker);
+    if ( _rare ){
+      attribs.add("begintime",_rare->begintime);
+      attribs.add("endtime",_rare->endtime);
+      attribs.add("src",_rare->src);
+      attribs.add("tag",_rare->tags);
+      attribs.add("metadata",_rare->metadata);
+      attribs.add("speaker",_rare->speaker);
+    }
     if ( ( supported % Attrib::TEXTCLASS )
 	 && ( !_textclass.empty() &&
 	      ( _textclass != "current" || Explicit ) ) ){
       attribs.add("textclass",_textclass);
     }
 
-    if ( _confidence >= 0 ) {
-      attribs.add("confidence",toDoubleString(_confidence));
+    if ( confidence() >= 0 ) {
+      attribs.add("confidence",toDoubleString(confidence()));
     }
-    attribs.add("n",_n);
+    attribs.add("n",n());
     if ( !_auth ) {
       attribs.add("auth","no");
     }
@@ -1417,6 +1780,29 @@ namespace folia {
     return TiCC::UnicodeToUTF8( unicode( tp ) );
   }
 
+  static const string *plain_text_value( const FoliaElement *,
+					 const TextPolicy& );
+
+  void FoliaElement::text_utf8( const TextPolicy& tp, string& out ) const {
+    /// append the UTF8 value of this element to out
+    /*!
+     * \param tp the TextPolicy to use
+     * \param out the string to append to
+     *
+     * The result is the same as str( tp ), but is appended to the caller's
+     * buffer. A TextContent or a Word with a TextContent holding just one
+     * plain line of text is handled without any UTF16 conversion.
+     */
+    if ( !tp.debug() ){
+      const string *plain = plain_text_value( this, tp );
+      if ( plain ){
+	out += *plain;
+	return;
+      }
+    }
+    unicode( tp ).toUTF8String( out );
+  }
+
     bool FoliaElement::hastext( const string& cls ) const {
     /// check if the element has a TextContent with class 'cls'
     /*!
@@ -1531,7 +1917,7 @@ namespace folia {
      */
     UnicodeString txt_u = TiCC::UnicodeFromUTF8( txt );
     if ( doc() && doc()->checktext()
-	 && !isSubClass<Morpheme>() && !isSubClass<Phoneme>() ){
+	 && !is_a( ElementType::Morpheme_t ) && !is_a( ElementType::Phoneme_t ) ){
       UnicodeString deeper_u;
       try {
 	deeper_u = text( cls );
@@ -1610,7 +1996,7 @@ namespace folia {
      * otherwise not, and the empty string is returned.
      */
     string att;
-    if ( c->isSubClass<AbstractFeature>() ) {
+    if ( c->is_a( ElementType::AbstractFeature_t ) ) {
       att = c->xmltag();
       if ( att == "feat" ) {
 	// "feat" is a Feature_t too. exclude!
@@ -1644,10 +2030,10 @@ namespace folia {
       s2 = normalize_spaces( s2 );
       if ( !s1.isEmpty() && !s2.isEmpty() ){
 	bool test_fail;
-	if ( child->isSubClass<TextContent>()
-	     || child->isSubClass<AbstractTextMarkup>()
-	     || child->isSubClass<String>()
-	     || child->isSubClass<Word>() ){
+	if ( child->is_a( ElementType::TextContent_t )
+	     || child->is_a( ElementType::AbstractTextMarkup_t )
+	     || child->is_a( ElementType::String_t )
+	     || child->is_a( ElementType::Word_t ) ){
 	  // Words and Strings are 'per definition' PART of their parents
 	  test_fail = ( s1.indexOf( s2 ) < 0 ); // aren't they?
 	}
@@ -1694,9 +2080,9 @@ namespace folia {
       s1 = normalize_spaces( s1 );
       s2 = normalize_spaces( s2 );
       bool test_fail;
-      if ( child->isSubClass<Word>()
-	   || child->isSubClass<String>()
-	   || child->isSubClass<AbstractTextMarkup>() ) {
+      if ( child->is_a( ElementType::Word_t )
+	   || child->is_a( ElementType::String_t )
+	   || child->is_a( ElementType::AbstractTextMarkup_t ) ) {
 	// Words, Strings and AbstractTextMarkup are 'per definition' PART of
 	// their text parents
 	test_fail = ( s1.indexOf( s2 ) < 0 ); // aren't they?
@@ -1926,6 +2312,12 @@ namespace folia {
 	throw XmlError( this, msg );
       }
     }
+    if ( _parse_texts && trim_spaces ){
+      // the texts of our children are not needed anymore
+      for ( const auto *child : _data ){
+	_parse_texts->texts.erase( child );
+      }
+    }
     if ( txt_dbg ){
       DBG << "DEBUG: END-OK check_text_consistency_while_parsing("
 	   << trim_spaces << ")" << endl;
@@ -2121,8 +2513,8 @@ namespace folia {
      *
      * This function recurses upward to the first element which carries _src
      */
-    if ( !_src.empty() ) {
-      return _src;
+    if ( !src().empty() ) {
+      return src();
     }
     if ( _parent ) {
       return _parent->speech_src();
@@ -2137,8 +2529,8 @@ namespace folia {
      *
      * This function recurses upward to the first element which carries _speaker
      */
-    if ( !_speaker.empty() ) {
-      return _speaker;
+    if ( _rare && !_rare->speaker.empty() ) {
+      return _rare->speaker;
     }
     if ( _parent ) {
       return _parent->speech_speaker();
@@ -2202,11 +2594,11 @@ namespace folia {
       const FoliaElement *last = _data.back();
       if ( last && tp.debug() ){
 	DBG << "last is " << last << endl;
-	DBG << "isSubClass<AbstractWord>() == " << last->isSubClass<AbstractWord>() << endl;
+	DBG << "isSubClass<AbstractWord>() == " << last->is_a( ElementType::AbstractWord_t ) << endl;
 	DBG << "last->space() == " << last->space() << endl;
       }
       if ( last
-	   && last->isSubClass<AbstractWord>()
+	   && last->is_a( ElementType::AbstractWord_t )
 	   && !last->space() ){
 	return EMPTY_STRING;
       }
@@ -2220,7 +2612,7 @@ namespace folia {
     else if ( _data.size() > 0 ) {
       // attempt to get a delimiter from the last child
       const FoliaElement *last = _data.back();
-      if ( last->isSubClass<AbstractWord>() ){
+      if ( last->is_a( ElementType::AbstractWord_t ) ){
 	const string& det = last->get_delimiter( tp );
 	if ( tp.debug() ){
 	  DBG << "out <" << xmltag() << ">:get_delimiter ==> '" << det << "'"
@@ -2242,6 +2634,147 @@ namespace folia {
 	     || kar == 0x000d ); // carriage return
   }
 
+  static bool is_plain_line( const UnicodeString& txt ){
+    /// check if the FoLiA >= v2.5 space handling would leave txt unchanged
+    /*!
+     * \param txt the text to check
+     * \return true when txt has no newlines, no leading or trailing spaces,
+     * no multiple spaces and no other whitespace or control characters.
+     * normalize_spaces() and trim_space() would return txt as is, then.
+     *
+     * This is a scalar loop which stops at the first offending code unit.
+     * Code units below U+00A0 are decided by plain comparisons, only the
+     * others are checked using ICU.
+     */
+    const int len = txt.length();
+    if ( len == 0 ){
+      return true;
+    }
+    const UChar *buf = txt.getBuffer();
+    if ( !buf
+	 || buf[0] == 0x0020
+	 || buf[len-1] == 0x0020 ){
+      return false;
+    }
+    UChar prev = 0;
+    for ( int i=0; i < len; ++i ){
+      const UChar c = buf[i];
+      if ( c > 0x0020 && c < 0x007f ){
+	// printable ASCII
+      }
+      else if ( c == 0x0020 ){
+	if ( prev == 0x0020 ){
+	  return false;
+	}
+      }
+      else if ( c < 0x00a0 ){
+	// ASCII and Latin-1 control characters, including tab and newline
+	return false;
+      }
+      else if ( c != 0x00ad // the soft hyphen is kept by normalize_spaces()
+		&& ( u_isspace( c ) || u_iscntrl( c ) ) ){
+	return false;
+      }
+      prev = c;
+    }
+    return true;
+  }
+
+  static bool is_plain_utf8( const string& txt ){
+    /// the UTF8 equivalent of is_plain_line()
+    /*!
+     * \param txt the UTF8 text to check
+     * \return true when is_plain_line() would be true for the UTF16 version
+     * of txt. false for invalid UTF8
+     */
+    const int32_t len = txt.size();
+    if ( len == 0 ){
+      return true;
+    }
+    if ( txt[0] == ' ' || txt[len-1] == ' ' ){
+      return false;
+    }
+    const uint8_t *buf = reinterpret_cast<const uint8_t*>( txt.data() );
+    int32_t i = 0;
+    UChar32 prev = 0;
+    while ( i < len ){
+      UChar32 c;
+      U8_NEXT( buf, i, len, c );
+      if ( c > 0x0020 && c < 0x007f ){
+	// printable ASCII
+      }
+      else if ( c == 0x0020 ){
+	if ( prev == 0x0020 ){
+	  return false;
+	}
+      }
+      else if ( c < 0x00a0 ){
+	// control characters and invalid sequences (c < 0)
+	return false;
+      }
+      else if ( c < 0x10000 // the surrogates of the others are plain
+		&& c != 0x00ad
+		&& ( u_isspace( c ) || u_iscntrl( c ) ) ){
+	return false;
+      }
+      prev = c;
+    }
+    return true;
+  }
+
+  static const string *plain_text_value( const FoliaElement *elt,
+					 const TextPolicy& tp ){
+    /// find the UTF8 text of elt, when it is just one plain XmlText
+    /*!
+     * \param elt a TextContent or a Word
+     * \param tp the TextPolicy to use
+     * \return the value of the XmlText when elt->text( tp ) would return
+     * exactly that. 0 otherwise, also for all other elements.
+     *
+     * This follows the path of private_text(), deeptext() and
+     * text_container_text() for these simple cases.
+     */
+    const TextContent *tc = 0;
+    try {
+      if ( elt->isinstance<TextContent>() ){
+	tc = elt->text_content( tp );
+      }
+      else if ( elt->element_id() == ElementType::Word_t ){
+	if ( !tp.is_set( TEXT_FLAGS::STRICT ) ){
+	  for ( const auto *child : elt->data() ){
+	    if ( child->printable()
+		 && ( is_structure( child )
+		      || child->is_a( ElementType::AbstractSpanAnnotation_t )
+		      || child->isinstance<Correction>() )
+		 && !child->isinstance<TextContent>() ){
+	      // deeptext() might find text in the children
+	      return 0;
+	    }
+	  }
+	}
+	tc = elt->text_content( tp ); // STRICT doesn't matter here
+      }
+    }
+    catch ( const NoSuchText& ){
+      // let text() decide what to do
+    }
+    if ( !tc
+	 || ( tc->hidden() && !tp.is_set( TEXT_FLAGS::HIDDEN ) )
+	 || tc->size() != 1 ){
+      return 0;
+    }
+    const XmlText *xt = dynamic_cast<const XmlText*>( tc->index(0) );
+    if ( !xt
+	 || xt->value().empty() ){
+      return 0;
+    }
+    if ( tp.is_set( TEXT_FLAGS::NO_TRIM_SPACES )
+	 || is_plain_utf8( xt->value() ) ){
+      return &xt->value();
+    }
+    return 0;
+  }
+
   UnicodeString AbstractElement::text_container_text( const TextPolicy& tp ) const {
     string desired_class = tp.get_class();
     if ( isinstance<TextContent>()
@@ -2255,6 +2788,7 @@ namespace folia {
     }
     UnicodeString result;
     bool pendingspace = false;
+    bool placeholders = false; // might result contain \1 placeholders?
     bool trim_spaces = !tp.is_set( TEXT_FLAGS::NO_TRIM_SPACES);
     if ( tp.debug() ){
       DBG << "TextContainer.text() " << xmltag() << "[";
@@ -2273,8 +2807,14 @@ namespace folia {
 	if ( trim_spaces) {
 	  //This implements https://github.com/proycon/folia/issues/88
 	  //FoLiA >= v2.5 behaviour (introduced earlier in v2.4.1 but modified thereafter)
-	  const int l = result.length();
 	  UnicodeString txt = d->text( tp );
+	  if ( is_plain_line( txt ) ){
+	    // the common case: a single line with nothing to trim or normalize
+	    result += txt;
+	    continue;
+	  }
+	  placeholders = true;
+	  const int l = result.length();
 	  int begin = 0;
 	  int linenr = 0;
 	  for ( int i = 0; i < txt.length(); ++i ) {
@@ -2342,6 +2882,7 @@ namespace folia {
       }
       else if ( d->printable() ){
 	// this is some TextMarkup I hope
+	placeholders = true;
 	if (pendingspace) {
 	  if (!d->implicitspace()) result += " ";
 	  pendingspace = false;
@@ -2377,7 +2918,9 @@ namespace folia {
 	// non interesting stuff like <feature>, <comment> etc.
       }
     }
-    if (trim_spaces && this->spaces_flag() != SPACE_FLAGS::PRESERVE) {
+    if ( trim_spaces
+	 && placeholders
+	 && this->spaces_flag() != SPACE_FLAGS::PRESERVE) {
       result = postprocess_spaces(result);
     }
     if ( tp.debug() ){
@@ -2440,6 +2983,157 @@ namespace folia {
     return result;
   }
 
+  thread_local unsigned int AbstractElement::_uncachable_texts = 0;
+
+  void AbstractElement::mark_text_uncachable(){
+    /// signal that the text being computed depends on nodes outside the
+    /// subtree, (like the target of a WordReference) so it can't be cached
+    ++_uncachable_texts;
+  }
+
+  const UnicodeString AbstractElement::cached_text( const TextPolicy& tp ) const {
+    /// get the text of an element, remembering it when the CACHETEXT mode of
+    /// the Document is set
+    /*!
+     * \param tp The TextPolicy to use
+     * \return the text, as private_text() would return it
+     *
+     * The cache is keyed on the textclass, the TEXT_FLAGS and the correction
+     * handling of tp. Policies with tag handlers or debugging are never
+     * cached, neither are leaves, text containers (only reached through their
+     * parent) and nodes not yet connected to a parent.
+     *
+     * Inside a parse_scope the non-strict results are remembered in the memo
+     * of the thread instead, regardless of the CACHETEXT mode.
+     */
+    if ( _data.empty()
+	 || is_textcontainer()
+	 || tp.debug()
+	 || tp.has_handlers() ){
+      return private_text( tp );
+    }
+    if ( _parse_texts ){
+      if ( tp.is_set( TEXT_FLAGS::STRICT ) ){
+	// just a lookup of our own TextContent. Never needed by the parent
+	return private_text( tp );
+      }
+      return memo_text( tp );
+    }
+    if ( !doc()
+	 || !doc()->cachetext()
+	 || _preserve_spaces == SPACE_FLAGS::UNSET ){
+      return private_text( tp );
+    }
+    {
+      // the cache may be filled by another thread
+      lock_guard<mutex> lock( doc()->text_cache_mutex() );
+      const auto& caches = doc()->text_caches();
+      auto it = caches.find( this );
+      if ( it != caches.end() ){
+	for ( const auto& entry : it->second ){
+	  if ( entry.flags == tp.get_flags()
+	       && entry.correction == tp.get_correction_handling()
+	       && entry.cls == tp.get_class() ){
+	    return entry.text;
+	  }
+	}
+      }
+    }
+    unsigned int uncachable = _uncachable_texts;
+    UnicodeString result = private_text( tp );
+    if ( uncachable == _uncachable_texts ){
+      lock_guard<mutex> lock( doc()->text_cache_mutex() );
+      doc()->text_caches()[this].push_back( { tp.get_class(),
+					      tp.get_flags(),
+					      tp.get_correction_handling(),
+					      result } );
+      doc()->register_text_cache();
+    }
+    return result;
+  }
+
+  const UnicodeString AbstractElement::memo_text( const TextPolicy& tp ) const {
+    /// get the text of an element from the memo of the current parse_scope
+    /*!
+     * \param tp The TextPolicy to use
+     * \return the text, as private_text() would return it. A NoSuchText
+     * exception is remembered too, and thrown again.
+     */
+    bool preserve = ( _preserve_spaces == SPACE_FLAGS::PRESERVE );
+    const auto it = _parse_texts->texts.find( this );
+    if ( it != _parse_texts->texts.end() ){
+      for ( const auto& entry : it->second ){
+	if ( entry.flags == tp.get_flags()
+	     && entry.preserve == preserve
+	     && entry.correction == tp.get_correction_handling()
+	     && entry.cls == tp.get_class() ){
+	  if ( entry.error ){
+	    rethrow_exception( entry.error );
+	  }
+	  return entry.text;
+	}
+      }
+    }
+    unsigned int uncachable = _uncachable_texts;
+    UnicodeString result;
+    exception_ptr error;
+    try {
+      result = private_text( tp );
+    }
+    catch ( const NoSuchText& ){
+      error = current_exception();
+    }
+    if ( uncachable == _uncachable_texts ){
+      _parse_texts->texts[this].push_back( { tp.get_class(),
+					     tp.get_flags(),
+					     tp.get_correction_handling(),
+					     preserve,
+					     result,
+					     error } );
+    }
+    if ( error ){
+      rethrow_exception( error );
+    }
+    return result;
+  }
+
+  void AbstractElement::tree_changed( const FoliaElement *changed ){
+    /// register a change in the children of this node
+    /*!
+     * \param changed the child that was added or removed, or this node
+     * itself when its value changed
+     *
+     * The word lists of the Document that may hold a changed node are
+     * invalidated (see Document::invalidate_index()), and so are the cached
+     * texts of this node and all its ancestors.
+     */
+    if ( _parse_texts ){
+      for ( const FoliaElement *p = this; p; p = p->parent() ){
+	_parse_texts->texts.erase( p );
+      }
+    }
+    if ( !doc() ){
+      return;
+    }
+    doc()->invalidate_index( this, changed );
+    if ( doc()->has_text_caches() ){
+      lock_guard<mutex> lock( doc()->text_cache_mutex() );
+      for ( FoliaElement *p = this; p; p = p->parent() ){
+	p->clear_text_cache();
+      }
+    }
+  }
+
+  void AbstractElement::clear_text_cache(){
+    /// forget the texts cached by cached_text()
+    /*!
+     * The caller must hold the text_cache_mutex() of the Document
+     */
+    if ( doc() ){
+      doc()->text_caches().erase( this );
+    }
+  }
+
   const UnicodeString AbstractElement::text( const TextPolicy& tp ) const {
     /// get the UnicodeString text value of an element
     /*!
@@ -2448,7 +3142,7 @@ namespace folia {
     if ( tp.debug() ){
       DBG << "DEBUG <" << xmltag() << ">.text() Policy=" << tp << endl;
     }
-    return private_text( tp );
+    return cached_text( tp );
   }
 
   const UnicodeString AbstractElement::text( const string& cls,
@@ -2465,7 +3159,7 @@ namespace folia {
     if ( txt_dbg ){
       DBG << "DEBUG <" << xmltag() << ">.text() Policy=" << tp << endl;
     }
-    return private_text( tp );
+    return cached_text( tp );
   }
 
   void FoLiA::setAttributes( KWargs& kwargs ){
@@ -2511,7 +3205,7 @@ namespace folia {
 	  meta_found = true;
 	}
 	else if ( TiCC::getNS(p) == NSFOLIA ){
-	  string tag = TiCC::Name( p );
+	  string_view tag = to_string_view( p->name );
 	  if ( !meta_found  && !doc()->version_below(1,6) ){
 	    if ( doc()->autodeclare() ){
 	      doc()->fixup_metadata();
@@ -2520,27 +3214,36 @@ namespace folia {
 	    }
 	    else {
 	      throw XmlError( this,
-			      "Expecting element metadata, got '" + tag + "'" );
+			      "Expecting element metadata, got '"
+			      + string(tag) + "'" );
 	    }
 	  }
 	  FoliaElement *t=0;
 	  try {
-	    t = AbstractElement::createElement( tag, doc() );
+	    t = AbstractElement::createElement( stringToElementType( tag ),
+						doc() );
 	  }
 	  catch ( const exception& e ){
 	    throw XmlError( this,
-			    string( "parsing <" ) + tag + "> failed:\n\t"
+			    "parsing <" + string(tag) + "> failed:\n\t"
 			    + e.what() );
 	  }
 	  if ( doc()->debug % DocDbg::PARSING ){
 	    DBG << "created " << t << endl;
 	  }
-	  t = t->parseXml( p );
-	  if ( t ){
-	    if ( doc()->debug % DocDbg::PARSING ){
-	      DBG << "extend " << this << " met " << tag << endl;
+	  try {
+	    FoliaElement *parsed = t->parseXml( p );
+	    if ( parsed ){
+	      if ( doc()->debug % DocDbg::PARSING ){
+		DBG << "extend " << this << " met " << tag << endl;
+	      }
+	      this->append( parsed );
 	    }
-	    this->append( t );
+	  }
+	  catch ( ... ){
+	    // t is not a child yet, so nobody else will delete it
+	    t->destroy();
+	    throw;
 	  }
 	}
       }
@@ -2603,62 +3306,70 @@ namespace folia {
      * Other 'whitespace' characters like newline and tab are retained!
      */
     const char16_t space = 0x0020;
-    //    DBG << "in = '" << in << "'" << endl;
-    UnicodeString out;
+    const int len = in.length();
+    const UChar *buf = in.getBuffer();
     int i = 0;
-    for( ; i < in.length(); ++i ){
-      //      DBG << "start: bekijk:" << UnicodeString(in[i]) << endl;
-      if ( in[i] != space ){
-	break;
-      }
+    while ( i < len && buf[i] == space ){
+      ++i;
     }
-    int j = in.length()-1;
-    for( ; j >= 0; --j ){
-      //      DBG << "end: bekijk:" << UnicodeString(in[j]) << endl;
-      if ( in[j] != space ){
-	break;
-      }
+    int j = len;
+    while ( j > i && buf[j-1] == space ){
+      --j;
     }
-    // DBG << "I=" << i << endl;
-    // DBG << "J=" << j << endl;
-    if ( j < i ){
-      //      DBG << "out = LEEG" << endl;
-      return out;
+    if ( i == 0 && j == len ){
+      // nothing to trim. (cheap, the buffer is shared)
+      return in;
     }
-    out = UnicodeString( in, i, j-i+1 );
-    //    DBG << "out = '" << out << "'" << endl;
-    return out;
+    return UnicodeString( in, i, j-i );
   }
 
   UnicodeString postprocess_spaces( const UnicodeString& in ){
     ///Postprocessing for spaces, translates temporary \1 codepoints to spaces
     /// if they are are not preceeded by whitespace
-    bool need_postprocessing = false;
-    for (int i = 0; i < in.length(); i++) {
-      if (in[i] == 0x0001) {
-	need_postprocessing = true;
-	break;
-      }
-    }
-    if (!need_postprocessing) {
+    /*!
+     * skip_ascii_range() is used to skip the runs without \1 (or \0),
+     * with SSE2 or AVX2 when available.
+     */
+    const int len = in.length();
+    const UChar *buf = in.getBuffer();
+    int first = 0;
+    while ( ( first = skip_ascii_range( buf, len, first, 0x0002, 0xffff ) )
+	    < len
+	    && buf[first] != 0x0001 ){
+      ++first;
+    }
+    if ( first == len ) {
       return in;
     }
-    else {
-      UnicodeString result;
-      for (int i = 0; i < in.length(); ++i) {
-	if ( in[i] == 0x0001 ) {
-	  if ( i > 0
-	       && !is_space(in[i-1]) ){
-	    result.append((UChar32) 0x0020); //add a space
-	    // 1 byte is dropped otherwise
-	  }
-	}
-	else {
-	  result.append(in[i]);
+    UnicodeString result;
+    UChar *out = result.getBuffer( len );
+    if ( !out ){
+      throw bad_alloc();
+    }
+    copy( buf, buf+first, out );
+    int n = first;
+    int i = first;
+    while ( i < len ){
+      const int run = skip_ascii_range( buf, len, i, 0x0002, 0xffff );
+      copy( buf+i, buf+run, out+n );
+      n += run - i;
+      i = run;
+      if ( i == len ){
+	break;
+      }
+      if ( buf[i] == 0x0001 ) {
+	if ( i > 0
+	     && !is_space(buf[i-1]) ){
+	  out[n++] = 0x0020; //add a space
 	}
       }
-      return result;
+      else {
+	out[n++] = buf[i];
+      }
+      ++i;
     }
+    result.releaseBuffer( n );
+    return result;
   }
 
   bool check_end( const UnicodeString& us, bool& only ){
@@ -2743,7 +3454,7 @@ namespace folia {
       }
       if ( child->printable()
 	   && ( is_structure( child )
-		|| child->isSubClass<AbstractSpanAnnotation>()
+		|| child->is_a( ElementType::AbstractSpanAnnotation_t )
 		|| child->isinstance<Correction>() )
 	   && !child->isinstance<TextContent>() ) {
 	if ( tp.debug() ){
@@ -3118,6 +3829,24 @@ namespace folia {
   }
 
 
+  static void check_acceptable( const FoliaElement *parent,
+				const FoliaElement *child ){
+    /// throw when \em child may not be a direct child of \em parent
+    /*!
+     * Every way to add a child must pass this test. select() skips the
+     * subtrees that contained_types() says cannot hold a match, which is
+     * only valid when no node holds a child it doesn't accept.
+     */
+    if ( !parent->acceptable( child->element_id() ) ) {
+      string mess = "Unable to append object of type " + child->classname()
+	+ " to a <" + parent->classname() + ">";
+      if ( !parent->id().empty() ){
+	mess += " (id=" + parent->id() + ")";
+      }
+      throw ValueError( child, mess );
+    }
+  }
+
   vector<FoliaElement *>AbstractElement::find_replacables( FoliaElement *par ) const {
     // find all children with the same signature as the parameter
     /*!
@@ -3167,9 +3896,17 @@ namespace folia {
 		       _data.end(),
 		       [&]( const FoliaElement *el ){ return el == old; } );
     if ( it != _data.end() ){
+      check_acceptable( this, _new );
       *it = _new;
       result = old;
       _new->set_parent(this);
+      tree_changed( old );
+      if ( doc() ){
+	doc()->invalidate_index( this, _new );
+	if ( old->parent() == this ){
+	  doc()->keep_detached( old );
+	}
+      }
     }
     return result;
   }
@@ -3180,12 +3917,14 @@ namespace folia {
      * \param pos The location after which to insert add
      * \param add the element to add
      *
-     * throws when pos is not found
+     * throws when pos is not found, or when add is not acceptable here
      */
+    check_acceptable( this, add );
     auto it = _data.begin();
     while ( it != _data.end() ) {
       if ( *it == pos ) {
 	it = _data.insert( ++it, add );
+	tree_changed( add );
 	break;
       }
       ++it;
@@ -3223,19 +3962,10 @@ namespace folia {
      * \param t the ElementType to test
      *
      * This function tests if t is in the accepted_data list of the node
-     * OR if it is a SubClass of one of the accepted types
+     * OR if it is a SubClass of one of the accepted types.
+     * Both are precomputed in the ACCEPTED_BITS property.
      */
-
-    auto it = accepted_data().find( t );
-    if ( it != accepted_data().end() ) {
-      return true;
-    }
-    else {
-      return any_of( accepted_data().cbegin(),
-		     accepted_data().cend(),
-		     [t]( const ElementType& et) {
-		       return ( folia::is_subtype( t, et ) ); } );
-    }
+    return _props.ACCEPTED_BITS.test( static_cast<size_t>(t) );
   }
 
   bool AbstractElement::addable( const FoliaElement *parent ) const {
@@ -3246,14 +3976,7 @@ namespace folia {
      *
      * \note It will allways throw an error, instead of returning false
      */
-    if ( !parent->acceptable( element_id() ) ) {
-      string mess = "Unable to append object of type " + classname()
-	+ " to a <" + parent->classname() + ">";
-      if ( !parent->id().empty() ){
-	mess += " (id=" + parent->id() + ")";
-      }
-      throw ValueError( this, mess );
-    }
+    check_acceptable( parent, this );
     if ( occurrences() > 0 ) {
       vector<FoliaElement*> v = parent->select( element_id(),
 						SELECT_FLAGS::LOCAL );
@@ -3396,12 +4119,12 @@ namespace folia {
       throw ValueError( this,
 			"attribute 'Annotatortype' is required for " + classname() );
     }
-    if ( _confidence == -1 &&
+    if ( confidence() == -1 &&
 	 ( required_attributes() % Attrib::CONFIDENCE  ) ) {
       throw ValueError( this,
 			"attribute 'confidence' is required for " + classname() );
     }
-    if ( _n.empty()
+    if ( n().empty()
 	 && ( required_attributes() % Attrib::N  ) ) {
       throw ValueError( this,
 			"attribute 'n' is required for " + classname() );
@@ -3411,27 +4134,27 @@ namespace folia {
       throw ValueError( this,
 			"attribute 'datetime' is required for " + classname() );
     }
-    if ( _begintime.empty()
+    if ( begintime().empty()
 	 && ( required_attributes() % Attrib::BEGINTIME  ) ) {
       throw ValueError( this,
 			"attribute 'begintime' is required for " + classname() );
     }
-    if ( _endtime.empty()
+    if ( endtime().empty()
 	 && ( required_attributes() % Attrib::ENDTIME  ) ) {
       throw ValueError( this,
 			"attribute 'endtime' is required for " + classname() );
     }
-    if ( _src.empty()
+    if ( src().empty()
 	 && ( required_attributes() % Attrib::SRC  ) ) {
       throw ValueError( this,
 			"attribute 'src' is required for " + classname() );
     }
-    if ( _metadata.empty()
+    if ( ( !_rare || _rare->metadata.empty() )
 	 && ( required_attributes() % Attrib::METADATA  ) ) {
       throw ValueError( this,
 			"attribute 'metadata' is required for " + classname() );
     }
-    if ( _speaker.empty()
+    if ( ( !_rare || _rare->speaker.empty() )
 	 && ( required_attributes() % Attrib::SPEAKER  ) ) {
       throw ValueError( this,
 			"attribute 'speaker' is required for " + classname() );
@@ -3479,6 +4202,7 @@ namespace folia {
 	child->assignDoc( doc() );
       }
       _data.push_back(child);
+      tree_changed( child );
       if ( !child->parent() ) {
 	child->set_parent(this);
       }
@@ -3515,6 +4239,10 @@ namespace folia {
     }
     auto it = std::remove( _data.begin(), _data.end(), child );
     _data.erase( it, _data.end() );
+    tree_changed( child );
+    if ( doc() && child->parent() == this ){
+      doc()->keep_detached( child );
+    }
   }
 
   FoliaElement* AbstractElement::index( size_t i ) const {
@@ -3561,6 +4289,107 @@ namespace folia {
     throw range_error( "[] rindex out of range" );
   }
 
+  template <typename M>
+  static void select_matches( const FoliaElement *node,
+			      const M& matches,
+			      const bitset<ELEMENT_TYPE_COUNT>& targets,
+			      const set<ElementType>& exclude,
+			      SELECT_FLAGS flag,
+			      vector<FoliaElement*>& res ){
+    /// the recursive part of select() and select_set()
+    /*!
+     * \param node the node to search
+     * \param matches a predicate telling which nodes we are looking for
+     * \param targets the ElementTypes that matches() might accept.
+     * Subtrees which cannot contain any of them are not searched.
+     * \param exclude a set of ElementType to exclude from searching.
+     * \param flag the search strategy, see AbstractElement::select()
+     * \param res the vector to add the matches to
+     */
+    for ( const auto& el : node->data() ) {
+      if ( matches( el ) ) {
+	res.push_back( el );
+	if ( flag == SELECT_FLAGS::TOP_HIT ){
+	  flag = SELECT_FLAGS::LOCAL;
+	}
+      }
+      if ( flag != SELECT_FLAGS::LOCAL ){
+	// not at this level, search deeper when recurse is true
+	ElementType et = el->element_id();
+	if ( ( contained_types( et ) & targets ).any()
+	     && exclude.find( et ) == exclude.end() ) {
+	  select_matches( el, matches, targets, exclude, flag, res );
+	}
+      }
+    }
+  }
+
+  select_walker::select_walker( const FoliaElement *root,
+				ElementType et,
+				const string& st,
+				const set<ElementType>& exclude,
+				SELECT_FLAGS flag ):
+    _type( et ),
+    _set_key( 0 )
+  {
+    /// set up a walk over the nodes below root
+    /*!
+     * \param root the node to search
+     * \param et which type of element we are looking for
+     * \param st when not empty ("") we also must match on the 'sett' of the nodes
+     * \param exclude a set of ElementType to exclude from searching.
+     * \param flag the search strategy, see AbstractElement::select()
+     */
+    if ( !st.empty() ){
+      _set_key = interned_string::lookup( st );
+      if ( !_set_key ){
+	// no node can have this set, leave the stack empty
+	return;
+      }
+    }
+    if ( et >= ElementType::LastElement ){
+      return;
+    }
+    for ( const auto& ex : exclude ){
+      if ( ex < ElementType::LastElement ){
+	_exclude.set( static_cast<size_t>(ex) );
+      }
+    }
+    _stack.reserve( 16 );
+    _stack.push_back( { &root->data(), 0, flag } );
+  }
+
+  FoliaElement *select_walker::next(){
+    /// return the next matching node, or 0 when the walk is done
+    while ( !_stack.empty() ){
+      level& top = _stack.back();
+      if ( top.pos >= top.data->size() ){
+	_stack.pop_back();
+	continue;
+      }
+      FoliaElement *el = (*top.data)[top.pos++];
+      ElementType et = el->element_id();
+      // set names are interned, so comparing the addresses is enough
+      bool hit = ( et == _type
+		   && ( _set_key == 0 || &el->sett() == _set_key ) );
+      if ( hit && top.flag == SELECT_FLAGS::TOP_HIT ){
+	top.flag = SELECT_FLAGS::LOCAL;
+      }
+      if ( top.flag != SELECT_FLAGS::LOCAL
+	   && el->size() > 0
+	   && contained_types( et ).test( static_cast<size_t>(_type) )
+	   && !_exclude.test( static_cast<size_t>(et) ) ){
+	// search deeper, directly after el
+	SELECT_FLAGS flag = top.flag;
+	_stack.push_back( { &el->data(), 0, flag } );
+      }
+      if ( hit ){
+	return el;
+      }
+    }
+    return 0;
+  }
+
   vector<FoliaElement*> AbstractElement::select( ElementType et,
 						 const string& st,
 						 const set<ElementType>& exclude,
@@ -3581,21 +4410,9 @@ namespace folia {
      *               of matching node
      */
     vector<FoliaElement*> res;
-    for ( const auto& el : _data ) {
-      if ( el->element_id() == et &&
-	   ( st.empty() || el->sett() == st ) ) {
-	res.push_back( el );
-	if ( flag == SELECT_FLAGS::TOP_HIT ){
-	  flag = SELECT_FLAGS::LOCAL;
-	}
-      }
-      if ( flag != SELECT_FLAGS::LOCAL ){
-	// not at this level, search deeper when recurse is true
-	if ( exclude.find( el->element_id() ) == exclude.end() ) {
-	  vector<FoliaElement*> tmp = el->select( et, st, exclude, flag );
-	  res.insert( res.end(), tmp.begin(), tmp.end() );
-	}
-      }
+    select_walker walker( this, et, st, exclude, flag );
+    while ( FoliaElement *el = walker.next() ){
+      res.push_back( el );
     }
     return res;
   }
@@ -3623,22 +4440,25 @@ namespace folia {
      *
      */
     vector<FoliaElement*> res;
-    for ( const auto& el : _data ) {
-      if ( elts.find(el->element_id()) != elts.end() &&
-	   ( st.empty() || el->sett() == st ) ) {
-	res.push_back( el );
-	if ( flag == SELECT_FLAGS::TOP_HIT ){
-	  flag = SELECT_FLAGS::LOCAL;
-	}
+    const string *set_key = 0;
+    if ( !st.empty() ){
+      set_key = interned_string::lookup( st );
+      if ( !set_key ){
+	// no node can have this set
+	return res;
       }
-      if ( flag != SELECT_FLAGS::LOCAL ){
-	// not at this level, search deeper when recurse is true
-	if ( exclude.find( el->element_id() ) == exclude.end() ) {
-	  vector<FoliaElement*> tmp = el->select_set( elts, st, exclude, flag );
-	  res.insert( res.end(), tmp.begin(), tmp.end() );
-	}
+    }
+    auto matches = [&elts,set_key]( const FoliaElement *el ){
+      return elts.find( el->element_id() ) != elts.end()
+	&& ( set_key == 0 || &el->sett() == set_key );
+    };
+    bitset<ELEMENT_TYPE_COUNT> targets;
+    for ( const auto& et : elts ){
+      if ( et < ElementType::LastElement ){
+	targets.set( static_cast<size_t>(et) );
       }
     }
+    select_matches( this, matches, targets, exclude, flag, res );
     return res;
   }
 
@@ -3692,22 +4512,98 @@ namespace folia {
     }
   }
 
+  void AbstractElement::gather( vector<FoliaElement*>& store ){
+    /// collect this node and all its children, for release()
+    /*!
+     * \param store the vector to add the nodes to
+     * Every node is only added once, even when it is reachable via several
+     * parents (like Word nodes in a span). Unlike unravel() the tree itself
+     * is left untouched, so this is linear in the number of nodes.
+     * The refcount is not needed anymore, so a negative value marks the
+     * nodes that are already gathered.
+     */
+    if ( _refcount < 0 ){
+      return;
+    }
+    _refcount = -1;
+    store.push_back( this );
+    for ( const auto& el : _data ){
+      el->gather( store );
+    }
+  }
+
+  void AbstractElement::release(){
+    /// free this node without looking at parents, children or the Document
+    /*!
+     * This function is used when erasing a Document in arena mode, after
+     * gather() collected all nodes. The memory of nodes in the arena is
+     * not released here, but when the arena is deleted.
+     */
+    free_memory();
+  }
+
+  void AbstractElement::disown(){
+    /// cut the link with the Document
+    /*!
+     * This function is used when erasing a Document in arena mode, for
+     * the nodes that are detached from the tree but not destroyed. They
+     * stay valid, without a Document, until destroy() is called.
+     */
+    _mydoc = 0;
+    _refcount = 0;
+  }
+
   FoliaElement* AbstractElement::parseXml( const xmlNode *node ) {
     /// recursively parse a FoLiA tree starting at node
     /*!
      * \param node an xmlNode representing a FoLiA subtree
      * \return the parsed tree. Throws on error.
      */
-    KWargs atts = getAttributes( node );
+    attribute_bag bag;
+    getAttributes( node, bag );
     int sp = xmlNodeGetSpacePreserve(node);
     if ( sp == 1 ){
-      atts.add("xml:space","preserve");
+      bag.add("xml:space","preserve");
     }
     else if ( sp == 0 ){
-      atts.add("xml:space","default");
+      bag.add("xml:space","default");
     }
+    KWargs atts = bag.to_kwargs();
     setAttributes( atts );
     set_line_number( xmlGetLineNo(node) );
+    // the subtrees of the body may be parsed in parallel
+    bool parallel = doc()
+      && ( element_id() == ElementType::Text_t
+	   || element_id() == ElementType::Speech_t )
+      && doc()->parse_subtrees( node );
+    try {
+      parse_children( node, parallel );
+    }
+    catch ( ... ){
+      if ( parallel ){
+	doc()->discard_subtrees();
+      }
+      throw;
+    }
+    if ( parallel ){
+      doc()->discard_subtrees();
+    }
+    if ( doc() && ( doc()->checktext() || doc()->fixtext() )
+	 && this->printable()
+	 && !is_a( ElementType::Morpheme_t ) && !is_a( ElementType::Phoneme_t ) ){
+      check_text_consistency_while_parsing( true,
+					    doc()->debug % DocDbg::TEXTHANDLING );
+    }
+    return this;
+  }
+
+  void AbstractElement::parse_children( const xmlNode *node, bool parallel ){
+    /// parse all children of node and append them
+    /*!
+     * \param node the xmlNode to parse the children of
+     * \param parallel when true, the FoLiA element children are already
+     * parsed by Document::parse_subtrees(). They are collected here.
+     */
     const xmlNode *p = node->children;
     while ( p ) {
       set_line_number( xmlGetLineNo(p) );
@@ -3721,7 +4617,19 @@ namespace folia {
 	p = p->next;
 	continue;
       }
-      if ( p->type == XML_ELEMENT_NODE ) {
+      if ( p->type == XML_ELEMENT_NODE && parallel ){
+	FoliaElement *t = doc()->merge_subtree( this, p );
+	if ( t ){
+	  try {
+	    append( t );
+	  }
+	  catch ( ... ){
+	    t->destroy();
+	    throw;
+	  }
+	}
+      }
+      else if ( p->type == XML_ELEMENT_NODE ) {
 	string xml_tag = Name( p );
 	FoliaElement *t = 0;
 	try {
@@ -3737,12 +4645,19 @@ namespace folia {
 	if ( doc() && doc()->debug % DocDbg::PARSING ) {
 	  DBG << "created " << t << endl;
 	}
-	t = t->parseXml( p );
-	if ( t ) {
-	  if ( doc() && doc()->debug % DocDbg::PARSING ) {
-	    DBG << "extend " << this << " met " << t << endl;
+	try {
+	  FoliaElement *parsed = t->parseXml( p );
+	  if ( parsed ) {
+	    if ( doc() && doc()->debug % DocDbg::PARSING ) {
+	      DBG << "extend " << this << " met " << parsed << endl;
+	    }
+	    append( parsed );
 	  }
-	  append( t );
+	}
+	catch ( ... ){
+	  // t is not a child yet, so nobody else will delete it
+	  t->destroy();
+	  throw;
 	}
       }
       else if ( p->type == XML_PI_NODE ){
@@ -3838,13 +4753,6 @@ namespace folia {
       }
       p = p->next;
     }
-    if ( doc() && ( doc()->checktext() || doc()->fixtext() )
-	 && this->printable()
-	 && !isSubClass<Morpheme>() && !isSubClass<Phoneme>() ){
-      check_text_consistency_while_parsing( true,
-					    doc()->debug % DocDbg::TEXTHANDLING );
-    }
-    return this;
   }
 
   void AbstractElement::setDateTime( const string& s ) {
@@ -4542,7 +5450,7 @@ namespace folia {
      */
     vector<string> result;
     for ( const auto *el : data() ) {
-      if ( el->isSubClass<AbstractFeature>() &&
+      if ( el->is_a( ElementType::AbstractFeature_t ) &&
 	   el->subset() == s ) {
 	result.push_back( el->cls() );
       }
@@ -4558,7 +5466,7 @@ namespace folia {
      */
     const auto& it = find_if( _data.begin(), _data.end(),
 			      [s]( const FoliaElement *e ){
-				return ( e->isSubClass<AbstractFeature>()
+				return ( e->is_a( ElementType::AbstractFeature_t )
 					 && e->subset() == s ); } );
     if ( it == _data.end() ){
       return "";
@@ -4573,8 +5481,8 @@ namespace folia {
      * \return the _metadata or 0 if not available
      * may recurse upwards through the parent nodes
      */
-    if ( !_metadata.empty() && doc() ){
-      return doc()->get_submetadata(_metadata);
+    if ( _rare && !_rare->metadata.empty() && doc() ){
+      return doc()->get_submetadata(_rare->metadata);
     }
     else if ( parent() ){
       return parent()->get_metadata();
@@ -4590,8 +5498,8 @@ namespace folia {
      * \param key which metadata field do we want?
      * \return the metadata value for this key
      */
-    if ( !_metadata.empty() && doc() ){
-      const MetaData *what = doc()->get_submetadata(_metadata);
+    if ( _rare && !_rare->metadata.empty() && doc() ){
+      const MetaData *what = doc()->get_submetadata(_rare->metadata);
       if ( what && what->datatype() == "NativeMetaData" && !key.empty() ){
 	return what->get_val( key );
       }
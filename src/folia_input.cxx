@@ -0,0 +1,502 @@
+
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of libfolia
+
+  libfolia is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  libfolia is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/ticcutils/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+*/
+
+#include <cstring>
+#include <string>
+#include <map>
+#include <stdexcept>
+#include <exception>
+#include <sys/stat.h>
+#include "config.h"
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_BZLIB
+#include <bzlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "libfolia/folia_properties.h"
+#include "libfolia/folia_utils.h"
+#include "libfolia/folia_input.h"
+
+using namespace std;
+
+namespace folia {
+
+  /// size of the chunks of compressed input we read at once
+  const size_t INPUT_CHUNK_SIZE = 64*1024;
+
+  string toString( const Compression c ){
+    /// return a readable name for a Compression value
+    switch ( c ){
+    case Compression::GZIP:
+      return "gzip";
+    case Compression::BZIP2:
+      return "bzip2";
+    case Compression::XZ:
+      return "xz";
+    case Compression::ZSTD:
+      return "zstd";
+    default:
+      return "none";
+    }
+  }
+
+  Compression detect_compression( const unsigned char *bytes, size_t len ){
+    /// determine the compression format from the first bytes of the input
+    /*!
+      \param bytes the first bytes of the input
+      \param len the number of bytes available
+      \return the detected Compression. NONE when nothing matched
+    */
+    if ( len >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b ){
+      return Compression::GZIP;
+    }
+    if ( len >= 3 && bytes[0] == 'B' && bytes[1] == 'Z' && bytes[2] == 'h' ){
+      return Compression::BZIP2;
+    }
+    if ( len >= 6 && memcmp( bytes, "\xfd" "7zXZ\0", 6 ) == 0 ){
+      return Compression::XZ;
+    }
+    if ( len >= 4 && memcmp( bytes, "\x28\xb5\x2f\xfd", 4 ) == 0 ){
+      return Compression::ZSTD;
+    }
+    return Compression::NONE;
+  }
+
+  Compression detect_compression( const string& file_name ){
+    /// determine the compression format of a file from its magic bytes
+    /*!
+      \param file_name the file to inspect
+      \return the detected Compression. NONE for uncompressed or unreadable
+      files
+
+      Only regular files are inspected. Reading the magic bytes from a pipe
+      or a device would consume them, so those are left to libxml2.
+    */
+    struct stat st;
+    if ( stat( file_name.c_str(), &st ) != 0
+	 || !S_ISREG( st.st_mode ) ){
+      return Compression::NONE;
+    }
+    FILE *f = fopen( file_name.c_str(), "rb" );
+    if ( !f ){
+      return Compression::NONE;
+    }
+    unsigned char magic[6];
+    size_t len = fread( magic, 1, sizeof(magic), f );
+    fclose( f );
+    return detect_compression( magic, len );
+  }
+
+  Decompressor::Decompressor( const string& file_name ):
+    _file_name( file_name ),
+    _file( 0 ),
+    _in( INPUT_CHUNK_SIZE )
+  {
+    /// open file_name for decompression. Throws when that fails
+    _file = fopen( file_name.c_str(), "rb" );
+    if ( !_file ){
+      throw runtime_error( "unable to open: " + file_name );
+    }
+  }
+
+  Decompressor::~Decompressor(){
+    /// close the input file
+    fclose( _file );
+  }
+
+  size_t Decompressor::fill(){
+    /// read the next chunk of compressed input into _in
+    /*!
+      \return the number of bytes read. 0 at the end of the file
+    */
+    return fread( _in.data(), 1, _in.size(), _file );
+  }
+
+  void Decompressor::fail( const string& message ) const {
+    /// signal corrupt, truncated or otherwise unusable input
+    /*!
+      \param message what went wrong
+      Throws a DocumentError for the input file
+    */
+    throw DocumentError( _file_name, message );
+  }
+
+#ifdef HAVE_ZLIB
+  class GzDecompressor: public Decompressor {
+    /// Decompressor for gzip files, using zlib
+  public:
+    explicit GzDecompressor( const string& file_name ):
+      Decompressor( file_name ),
+      _strm(),
+      _in_member( false ),
+      _done( false )
+    {
+      // 15+32: maximal window, auto-detect a gzip or zlib header
+      if ( inflateInit2( &_strm, 15+32 ) != Z_OK ){
+	throw runtime_error( "unable to initialize zlib for: " + file_name );
+      }
+    }
+    ~GzDecompressor() override {
+      inflateEnd( &_strm );
+    }
+    int read( char *buffer, int len ) override {
+      _strm.next_out = reinterpret_cast<Bytef*>(buffer);
+      _strm.avail_out = len;
+      while ( _strm.avail_out > 0 && !_done ){
+	if ( _strm.avail_in == 0 ){
+	  _strm.avail_in = fill();
+	  _strm.next_in = _in.data();
+	  if ( _strm.avail_in == 0 ){
+	    if ( _in_member ){
+	      fail( "truncated gzip input" );
+	    }
+	    _done = true;
+	    break;
+	  }
+	}
+	_in_member = true;
+	int ret = inflate( &_strm, Z_NO_FLUSH );
+	if ( ret == Z_STREAM_END ){
+	  // there may be more gzip members concatenated
+	  inflateReset( &_strm );
+	  _in_member = false;
+	}
+	else if ( ret != Z_OK ){
+	  // this includes trailing garbage after the last member
+	  fail( string("corrupt gzip input: ")
+		+ ( _strm.msg ? _strm.msg : "inflate failed" ) );
+	}
+      }
+      return len - _strm.avail_out;
+    }
+  private:
+    z_stream _strm;
+    bool _in_member;
+    bool _done;
+  };
+#endif
+
+#ifdef HAVE_BZLIB
+  class Bz2Decompressor: public Decompressor {
+    /// Decompressor for bzip2 files, using libbz2
+  public:
+    explicit Bz2Decompressor( const string& file_name ):
+      Decompressor( file_name ),
+      _strm(),
+      _in_stream( false ),
+      _done( false )
+    {
+      if ( BZ2_bzDecompressInit( &_strm, 0, 0 ) != BZ_OK ){
+	throw runtime_error( "unable to initialize libbz2 for: " + file_name );
+      }
+    }
+    ~Bz2Decompressor() override {
+      BZ2_bzDecompressEnd( &_strm );
+    }
+    int read( char *buffer, int len ) override {
+      _strm.next_out = buffer;
+      _strm.avail_out = len;
+      while ( _strm.avail_out > 0 && !_done ){
+	if ( _strm.avail_in == 0 ){
+	  _strm.avail_in = fill();
+	  _strm.next_in = reinterpret_cast<char*>(_in.data());
+	  if ( _strm.avail_in == 0 ){
+	    if ( _in_stream ){
+	      fail( "truncated bzip2 input" );
+	    }
+	    _done = true;
+	    break;
+	  }
+	}
+	_in_stream = true;
+	int ret = BZ2_bzDecompress( &_strm );
+	if ( ret == BZ_STREAM_END ){
+	  // there may be more bzip2 streams concatenated (e.g. pbzip2)
+	  char *next_in = _strm.next_in;
+	  unsigned int avail_in = _strm.avail_in;
+	  char *next_out = _strm.next_out;
+	  unsigned int avail_out = _strm.avail_out;
+	  BZ2_bzDecompressEnd( &_strm );
+	  _strm = bz_stream();
+	  if ( BZ2_bzDecompressInit( &_strm, 0, 0 ) != BZ_OK ){
+	    fail( "unable to restart libbz2" );
+	  }
+	  _strm.next_in = next_in;
+	  _strm.avail_in = avail_in;
+	  _strm.next_out = next_out;
+	  _strm.avail_out = avail_out;
+	  _in_stream = false;
+	}
+	else if ( ret != BZ_OK ){
+	  // this includes trailing garbage after the last stream
+	  fail( "corrupt bzip2 input" );
+	}
+      }
+      return len - _strm.avail_out;
+    }
+  private:
+    bz_stream _strm;
+    bool _in_stream;
+    bool _done;
+  };
+#endif
+
+#ifdef HAVE_LZMA
+  class XzDecompressor: public Decompressor {
+    /// Decompressor for xz files, using liblzma
+  public:
+    explicit XzDecompressor( const string& file_name ):
+      Decompressor( file_name ),
+      _strm( LZMA_STREAM_INIT ),
+      _eof( false ),
+      _done( false )
+    {
+      if ( lzma_stream_decoder( &_strm, UINT64_MAX, LZMA_CONCATENATED )
+	   != LZMA_OK ){
+	throw runtime_error( "unable to initialize liblzma for: " + file_name );
+      }
+    }
+    ~XzDecompressor() override {
+      lzma_end( &_strm );
+    }
+    int read( char *buffer, int len ) override {
+      _strm.next_out = reinterpret_cast<uint8_t*>(buffer);
+      _strm.avail_out = len;
+      while ( _strm.avail_out > 0 && !_done ){
+	if ( _strm.avail_in == 0 && !_eof ){
+	  _strm.avail_in = fill();
+	  _strm.next_in = _in.data();
+	  _eof = ( _strm.avail_in == 0 );
+	}
+	lzma_ret ret = lzma_code( &_strm, _eof ? LZMA_FINISH : LZMA_RUN );
+	if ( ret == LZMA_STREAM_END ){
+	  _done = true;
+	}
+	else if ( ret == LZMA_BUF_ERROR && _eof ){
+	  fail( "unexpected end of xz input" );
+	}
+	else if ( ret != LZMA_OK ){
+	  // this includes trailing garbage after the last stream
+	  fail( "corrupt xz input" );
+	}
+      }
+      return len - _strm.avail_out;
+    }
+  private:
+    lzma_stream _strm;
+    bool _eof;
+    bool _done;
+  };
+#endif
+
+#ifdef HAVE_ZSTD
+  class ZstdDecompressor: public Decompressor {
+    /// Decompressor for Zstandard files, using libzstd
+  public:
+    explicit ZstdDecompressor( const string& file_name ):
+      Decompressor( file_name ),
+      _strm( ZSTD_createDStream() ),
+      _pos( 0 ),
+      _size( 0 ),
+      _pending( 0 ),
+      _done( false )
+    {
+      if ( !_strm || ZSTD_isError( ZSTD_initDStream( _strm ) ) ){
+	ZSTD_freeDStream( _strm );
+	throw runtime_error( "unable to initialize libzstd for: " + file_name );
+      }
+    }
+    ~ZstdDecompressor() override {
+      ZSTD_freeDStream( _strm );
+    }
+    int read( char *buffer, int len ) override {
+      ZSTD_outBuffer out = { buffer, static_cast<size_t>(len), 0 };
+      while ( out.pos < out.size && !_done ){
+	if ( _pos == _size ){
+	  _size = fill();
+	  _pos = 0;
+	  if ( _size == 0 ){
+	    if ( _pending != 0 ){
+	      // the last frame is incomplete
+	      fail( "truncated zstd input" );
+	    }
+	    _done = true;
+	    break;
+	  }
+	}
+	ZSTD_inBuffer in = { _in.data(), _size, _pos };
+	size_t ret = ZSTD_decompressStream( _strm, &out, &in );
+	if ( ZSTD_isError( ret ) ){
+	  // this includes trailing garbage after the last frame
+	  fail( string("corrupt zstd input: ") + ZSTD_getErrorName( ret ) );
+	}
+	// 0 means that a frame is completely decoded and flushed
+	_pending = ret;
+	_pos = in.pos;
+      }
+      return out.pos;
+    }
+  private:
+    ZSTD_DStream *_strm;
+    size_t _pos;
+    size_t _size;
+    size_t _pending;
+    bool _done;
+  };
+#endif
+
+  static map<Compression,DecompressorFactory>& decompressors(){
+    /// the registry of available Decompressors, with the built-in ones
+    static map<Compression,DecompressorFactory> registry = {
+#ifdef HAVE_ZLIB
+      { Compression::GZIP,
+	[]( const string& f ){ return new GzDecompressor( f ); } },
+#endif
+#ifdef HAVE_BZLIB
+      { Compression::BZIP2,
+	[]( const string& f ){ return new Bz2Decompressor( f ); } },
+#endif
+#ifdef HAVE_LZMA
+      { Compression::XZ,
+	[]( const string& f ){ return new XzDecompressor( f ); } },
+#endif
+#ifdef HAVE_ZSTD
+      { Compression::ZSTD,
+	[]( const string& f ){ return new ZstdDecompressor( f ); } },
+#endif
+    };
+    return registry;
+  }
+
+  void register_decompressor( const Compression c,
+			      const DecompressorFactory& factory ){
+    /// add or replace the Decompressor used for a Compression format
+    /*!
+      \param c the Compression format
+      \param factory a function creating a Decompressor on a file name
+
+      This is not thread-safe. Register before reading any documents.
+    */
+    if ( c == Compression::NONE ){
+      throw invalid_argument( "register_decompressor: no compression given" );
+    }
+    decompressors()[c] = factory;
+  }
+
+  bool has_decompressor( const Compression c ){
+    /// is there a Decompressor available for c?
+    return decompressors().find( c ) != decompressors().end();
+  }
+
+  Decompressor *create_decompressor( const string& file_name,
+				     const Compression c ){
+    /// create a Decompressor for file_name
+    /*!
+      \param file_name the file to decompress
+      \param c the Compression format of the file
+      \return a new Decompressor. Throws when there is none for format c
+    */
+    const auto& it = decompressors().find( c );
+    if ( it == decompressors().end() ){
+      throw runtime_error( "no support for " + toString( c )
+			   + " compressed input: " + file_name );
+    }
+    return it->second( file_name );
+  }
+
+  /// the error of the last failing Decompressor in this thread
+  /*!
+    libxml2 only sees a -1 from the input callback, and deletes the
+    Decompressor before we get control back. So the original exception is
+    kept here until check_decompress_error() picks it up.
+  */
+  static thread_local exception_ptr decompress_failure;
+
+  static int decompress_read( void *context, char *buffer, int len ){
+    /// libxml2 input callback
+    try {
+      return static_cast<Decompressor*>(context)->read( buffer, len );
+    }
+    catch ( ... ){
+      decompress_failure = current_exception();
+      return -1;
+    }
+  }
+
+  void check_decompress_error(){
+    /// rethrow the error of the last failing Decompressor, if any
+    /*!
+      Call this after parsing from decompress_reader() or
+      decompress_xmldoc(), also when the parse itself failed. The
+      Decompressor error is more informative than the XML error it causes.
+    */
+    if ( decompress_failure ){
+      exception_ptr e = decompress_failure;
+      decompress_failure = nullptr;
+      rethrow_exception( e );
+    }
+  }
+
+  static int decompress_close( void *context ){
+    /// libxml2 close callback
+    delete static_cast<Decompressor*>(context);
+    return 0;
+  }
+
+  xmlTextReader *decompress_reader( Decompressor *dc ){
+    /// create an xmlTextReader that reads from a Decompressor
+    /*!
+      \param dc the Decompressor. The reader takes ownership and will
+      delete it, also when creating the reader fails.
+      \return a new xmlTextReader, or 0 on failure
+    */
+    const string url = dc->file_name();
+    decompress_failure = nullptr;
+    return xmlReaderForIO( decompress_read, decompress_close, dc,
+			   url.c_str(), 0, XML_PARSER_OPTIONS );
+  }
+
+  xmlDoc *decompress_xmldoc( Decompressor *dc ){
+    /// parse a complete xmlDoc from a Decompressor
+    /*!
+      \param dc the Decompressor. It is deleted afterwards
+      \return a new xmlDoc, or 0 on failure
+    */
+    const string url = dc->file_name();
+    decompress_failure = nullptr;
+    return xmlReadIO( decompress_read, decompress_close, dc,
+		      url.c_str(), 0, XML_PARSER_OPTIONS );
+  }
+
+} // namespace folia
@@ -25,6 +25,7 @@
 */
 
 #include <set>
+#include <bitset>
 #include <string>
 #include <iostream>
 
@@ -650,7 +651,7 @@ namespace folia {
     return a;
   }
 
-  map<ElementType,properties*> element_props;
+  element_properties element_props;
   map<ElementType,ElementType> abstract_parents;
 
   ElementType get_abstract_parent( const ElementType et ) {
@@ -665,9 +666,82 @@ namespace folia {
     return get_abstract_parent( el->element_id() );
   }
 
+  static void init_subtype_matrix();
+
+  static void set_accepted_bits( properties& props ){
+    /// fill the ACCEPTED_BITS of props from its ACCEPTED_DATA
+    /*!
+      An ElementType is accepted when it is in ACCEPTED_DATA, or when it is
+      a subtype of one of the members of ACCEPTED_DATA.
+    */
+    props.ACCEPTED_BITS.reset();
+    for ( ElementType et = ElementType::BASE;
+	  et < ElementType::LastElement;
+	  ++et ){
+      for ( const auto& acc : props.ACCEPTED_DATA ){
+	if ( is_subtype( et, acc ) ){
+	  props.ACCEPTED_BITS.set( static_cast<size_t>(et) );
+	  break;
+	}
+      }
+    }
+  }
+
+  /// for every ElementType, all ElementTypes that may appear somewhere
+  /// below it. Set up by static_init()
+  static bitset<ELEMENT_TYPE_COUNT> containment_matrix[ELEMENT_TYPE_COUNT];
+
+  static void init_containment_matrix(){
+    /// fill containment_matrix with the transitive closure of ACCEPTED_BITS
+    for ( size_t i=0; i < ELEMENT_TYPE_COUNT; ++i ){
+      const properties *props = element_props[ElementType(i)];
+      if ( props ){
+	containment_matrix[i] = props->ACCEPTED_BITS;
+      }
+      else {
+	// unknown, so anything goes
+	containment_matrix[i].set();
+      }
+    }
+    bool changed = true;
+    while ( changed ){
+      changed = false;
+      for ( size_t i=0; i < ELEMENT_TYPE_COUNT; ++i ){
+	bitset<ELEMENT_TYPE_COUNT> row = containment_matrix[i];
+	for ( size_t j=0; j < ELEMENT_TYPE_COUNT; ++j ){
+	  if ( containment_matrix[i].test( j ) ){
+	    row |= containment_matrix[j];
+	  }
+	}
+	if ( row != containment_matrix[i] ){
+	  containment_matrix[i] = row;
+	  changed = true;
+	}
+      }
+    }
+  }
+
+  const bitset<ELEMENT_TYPE_COUNT>& contained_types( ElementType et ){
+    /// return all ElementTypes that may appear somewhere below an et
+    /*!
+      \param et the ElementType
+      \return a bitset, indexed by ElementType
+
+      This is derived from ACCEPTED_DATA, so a type not in the result can
+      never be found in a subtree of a node of type et.
+    */
+    static const bitset<ELEMENT_TYPE_COUNT> anything
+      = bitset<ELEMENT_TYPE_COUNT>().set();
+    if ( et >= ElementType::LastElement ){
+      return anything;
+    }
+    return containment_matrix[static_cast<size_t>(et)];
+  }
+
   void static_init(){
     /// initialize a lot of statics ('constants')
     /// This function should be called once.
+    init_subtype_matrix();
     FoLiA::PROPS.XMLTAG = "FoLiA";
     FoLiA::PROPS.ACCEPTED_DATA += { ElementType::Text_t, ElementType::Speech_t };
     FoLiA::PROPS.OPTIONAL_ATTRIBS = Attrib::ID;
@@ -1858,6 +1932,10 @@ namespace folia {
     ProcessingInstruction::PROPS.XMLTAG = "PI";
     ProcessingInstruction::PROPS.ELEMENT_ID = ElementType::ProcessingInstruction_t;
 
+    element_props[ElementType::XmlText_t] = &XmlText::PROPS;
+    element_props[ElementType::XmlComment_t] = &XmlComment::PROPS;
+    element_props[ElementType::ProcessingInstruction_t] = &ProcessingInstruction::PROPS;
+
     for ( const auto& [tag,val] : oldtags ){
       reverse_old[val] = tag;
     }
@@ -1865,6 +1943,16 @@ namespace folia {
     for ( const auto& [ann,et] : annotationtype_elementtype_map ){
       element_annotation_map[et] = ann;
     }
+
+    for ( ElementType et = ElementType::BASE;
+	  et < ElementType::LastElement;
+	  ++et ){
+      if ( element_props[et] ){
+	set_accepted_bits( *element_props[et] );
+      }
+    }
+    set_accepted_bits( DCOI::PROPS );
+    init_containment_matrix();
   }
 
 
@@ -1999,6 +2087,23 @@ namespace folia {
      { ElementType::Word_t, { ElementType::AbstractStructureElement_t,ElementType::AbstractWord_t } },
   };
 
+  /// the typeHierarchy as a bit matrix: row e1 holds all e2 with
+  /// is_subtype(e1,e2). Set up by static_init()
+  static bitset<ELEMENT_TYPE_COUNT> subtype_matrix[ELEMENT_TYPE_COUNT];
+
+  static void init_subtype_matrix(){
+    /// fill subtype_matrix from the typeHierarchy
+    for ( size_t i=0; i < ELEMENT_TYPE_COUNT; ++i ){
+      subtype_matrix[i].set( i );
+    }
+    for ( const auto& [et,supers] : typeHierarchy ){
+      for ( const auto& super : supers ){
+	subtype_matrix[static_cast<size_t>(et)]
+	  .set( static_cast<size_t>(super) );
+      }
+    }
+  }
+
   //foliaspec:oldtags_map
   const map<string,string> oldtags = {
     { "alignment", "relation" },
@@ -2333,11 +2438,12 @@ namespace folia {
     if ( e1 == e2 ){
       return true;
     }
-    const auto& it = typeHierarchy.find( e1 );
-    if ( it != typeHierarchy.end() ){
-      return it->second.find( e2 ) != it->second.end();
+    if ( e1 >= ElementType::LastElement
+	 || e2 >= ElementType::LastElement ){
+      return false;
     }
-    return false;
+    return subtype_matrix[static_cast<size_t>(e1)]
+      .test( static_cast<size_t>(e2) );
   }
 
   bool isAttributeFeature( const string& att ){
@@ -0,0 +1,299 @@
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of libfolia
+
+  libfolia is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  libfolia is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/ticcutils/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+*/
+
+#include <atomic>
+#include <string>
+#include "libfolia/folia_simd.h"
+
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__SSE2__) \
+  && defined(__GNUC__)
+#define FOLIA_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace folia {
+
+  // The scans return the first index, starting at 'from', of a code unit
+  // that needs a closer look. All versions must give the same answer.
+
+  static inline bool in_range( UChar c, UChar lo, UChar hi ){
+    return c >= lo && c <= hi;
+  }
+
+  static inline bool plain_unit( const UChar *buf, size_t i ){
+    /// is buf[i] printable ASCII, and not a space at the start or after
+    /// another space?
+    const UChar c = buf[i];
+    if ( c == 0x0020 ){
+      return i > 0 && buf[i-1] != 0x0020;
+    }
+    return in_range( c, 0x0021, 0x007e );
+  }
+
+  static size_t skip_ascii_range_scalar( const UChar *buf, size_t len,
+					 size_t from, UChar lo, UChar hi ){
+    size_t i = from;
+    while ( i < len && in_range( buf[i], lo, hi ) ){
+      ++i;
+    }
+    return i;
+  }
+
+  static size_t skip_plain_ascii_scalar( const UChar *buf, size_t len,
+					 size_t from ){
+    size_t i = from;
+    while ( i < len && plain_unit( buf, i ) ){
+      ++i;
+    }
+    return i;
+  }
+
+#ifdef FOLIA_X86_SIMD
+
+  // SSE2 has no unsigned 16 bit compare. c is in [lo,hi] when c-lo,
+  // wrapping around, is not above hi-lo, so when subtracting hi-lo with
+  // unsigned saturation gives 0.
+  // The SSE2 versions also handle the tails of the AVX2 ones. They are
+  // inlined there, so they are VEX encoded too: mixing that with plain SSE
+  // code is slow on some CPUs.
+
+  __attribute__((always_inline))
+  static inline size_t skip_ascii_range_sse2( const UChar *buf, size_t len,
+				       size_t from, UChar lo, UChar hi ){
+    const __m128i vlo = _mm_set1_epi16( static_cast<short>(lo) );
+    const __m128i vspan = _mm_set1_epi16( static_cast<short>(hi - lo) );
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = from;
+    for ( ; i + 8 <= len; i += 8 ){
+      __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(buf+i) );
+      __m128i over = _mm_subs_epu16( _mm_sub_epi16( v, vlo ), vspan );
+      unsigned int ok = _mm_movemask_epi8( _mm_cmpeq_epi16( over, zero ) );
+      if ( ok != 0xffff ){
+	return i + __builtin_ctz( ~ok ) / 2;
+      }
+    }
+    return skip_ascii_range_scalar( buf, len, i, lo, hi );
+  }
+
+  __attribute__((always_inline))
+  static inline size_t skip_plain_ascii_sse2( const UChar *buf, size_t len,
+				       size_t from ){
+    size_t i = from;
+    if ( i == 0 ){
+      // no previous unit to compare with
+      if ( len == 0 || !plain_unit( buf, 0 ) ){
+	return 0;
+      }
+      i = 1;
+    }
+    const __m128i vlo = _mm_set1_epi16( 0x0020 );
+    const __m128i vspan = _mm_set1_epi16( 0x007e - 0x0020 );
+    const __m128i space = _mm_set1_epi16( 0x0020 );
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; i + 8 <= len; i += 8 ){
+      __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(buf+i) );
+      __m128i prev
+	= _mm_loadu_si128( reinterpret_cast<const __m128i*>(buf+i-1) );
+      __m128i over = _mm_subs_epu16( _mm_sub_epi16( v, vlo ), vspan );
+      __m128i good = _mm_cmpeq_epi16( over, zero );
+      __m128i double_space = _mm_and_si128( _mm_cmpeq_epi16( v, space ),
+					    _mm_cmpeq_epi16( prev, space ) );
+      unsigned int ok = _mm_movemask_epi8( _mm_andnot_si128( double_space,
+							     good ) );
+      if ( ok != 0xffff ){
+	return i + __builtin_ctz( ~ok ) / 2;
+      }
+    }
+    return skip_plain_ascii_scalar( buf, len, i );
+  }
+
+  __attribute__((target("avx2")))
+  static size_t skip_ascii_range_avx2( const UChar *buf, size_t len,
+				       size_t from, UChar lo, UChar hi ){
+    const __m256i vlo = _mm256_set1_epi16( static_cast<short>(lo) );
+    const __m256i vspan = _mm256_set1_epi16( static_cast<short>(hi - lo) );
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = from;
+    for ( ; i + 16 <= len; i += 16 ){
+      __m256i v
+	= _mm256_loadu_si256( reinterpret_cast<const __m256i*>(buf+i) );
+      __m256i over = _mm256_subs_epu16( _mm256_sub_epi16( v, vlo ), vspan );
+      unsigned int ok = _mm256_movemask_epi8( _mm256_cmpeq_epi16( over,
+								   zero ) );
+      if ( ok != 0xffffffff ){
+	return i + __builtin_ctz( ~ok ) / 2;
+      }
+    }
+    return skip_ascii_range_sse2( buf, len, i, lo, hi );
+  }
+
+  __attribute__((target("avx2")))
+  static size_t skip_plain_ascii_avx2( const UChar *buf, size_t len,
+				       size_t from ){
+    size_t i = from;
+    if ( i == 0 ){
+      // no previous unit to compare with
+      if ( len == 0 || !plain_unit( buf, 0 ) ){
+	return 0;
+      }
+      i = 1;
+    }
+    const __m256i vlo = _mm256_set1_epi16( 0x0020 );
+    const __m256i vspan = _mm256_set1_epi16( 0x007e - 0x0020 );
+    const __m256i space = _mm256_set1_epi16( 0x0020 );
+    const __m256i zero = _mm256_setzero_si256();
+    for ( ; i + 16 <= len; i += 16 ){
+      __m256i v
+	= _mm256_loadu_si256( reinterpret_cast<const __m256i*>(buf+i) );
+      __m256i prev
+	= _mm256_loadu_si256( reinterpret_cast<const __m256i*>(buf+i-1) );
+      __m256i over = _mm256_subs_epu16( _mm256_sub_epi16( v, vlo ), vspan );
+      __m256i good = _mm256_cmpeq_epi16( over, zero );
+      __m256i double_space
+	= _mm256_and_si256( _mm256_cmpeq_epi16( v, space ),
+			    _mm256_cmpeq_epi16( prev, space ) );
+      unsigned int ok
+	= _mm256_movemask_epi8( _mm256_andnot_si256( double_space, good ) );
+      if ( ok != 0xffffffff ){
+	return i + __builtin_ctz( ~ok ) / 2;
+      }
+    }
+    return skip_plain_ascii_sse2( buf, len, i );
+  }
+
+#endif // FOLIA_X86_SIMD
+
+  SIMD_LEVEL simd_support(){
+    /// the best SIMD_LEVEL the CPU supports
+    static const SIMD_LEVEL best = [](){
+#ifdef FOLIA_X86_SIMD
+      __builtin_cpu_init();
+      if ( __builtin_cpu_supports( "avx2" ) ){
+	return SIMD_LEVEL::AVX2;
+      }
+      return SIMD_LEVEL::SSE2;
+#else
+      return SIMD_LEVEL::SCALAR;
+#endif
+    }();
+    return best;
+  }
+
+  static atomic<SIMD_LEVEL>& current_level(){
+    static atomic<SIMD_LEVEL> level( simd_support() );
+    return level;
+  }
+
+  SIMD_LEVEL simd_level(){
+    /// the SIMD_LEVEL the whitespace scans use now
+    return current_level().load( memory_order_relaxed );
+  }
+
+  SIMD_LEVEL set_simd_level( SIMD_LEVEL level ){
+    /// select the SIMD_LEVEL for the whitespace scans
+    /*!
+      \param level the wanted level. It is lowered to simd_support() when
+      the CPU can't do it.
+      \return the level now in use
+
+      Meant for testing and benchmarking: the best level is already used
+      by default.
+    */
+    if ( level > simd_support() ){
+      level = simd_support();
+    }
+    current_level().store( level, memory_order_relaxed );
+    return level;
+  }
+
+  string toString( SIMD_LEVEL level ){
+    switch ( level ){
+    case SIMD_LEVEL::AVX2:
+      return "avx2";
+    case SIMD_LEVEL::SSE2:
+      return "sse2";
+    default:
+      return "scalar";
+    }
+  }
+
+  size_t skip_ascii_range( const UChar *buf, size_t len, size_t from,
+			   UChar lo, UChar hi ){
+    /// find the first code unit outside [lo,hi]
+    /*!
+      \param buf the UTF16 buffer to scan
+      \param len the length of buf
+      \param from where to start
+      \param lo the lowest code unit to skip
+      \param hi the highest code unit to skip
+      \return the index of the first code unit from \e from that is below
+      \e lo or above \e hi. \e len when there is none.
+    */
+    if ( from >= len ){
+      return len;
+    }
+#ifdef FOLIA_X86_SIMD
+    switch ( simd_level() ){
+    case SIMD_LEVEL::AVX2:
+      return skip_ascii_range_avx2( buf, len, from, lo, hi );
+    case SIMD_LEVEL::SSE2:
+      return skip_ascii_range_sse2( buf, len, from, lo, hi );
+    default:
+      break;
+    }
+#endif
+    return skip_ascii_range_scalar( buf, len, from, lo, hi );
+  }
+
+  size_t skip_plain_ascii( const UChar *buf, size_t len, size_t from ){
+    /// find the first code unit that normalize_spaces() has to look at
+    /*!
+      \param buf the UTF16 buffer to scan
+      \param len the length of buf
+      \param from where to start
+      \return the index of the first code unit from \e from that is not
+      printable ASCII, or is a space at the start of buf or directly after
+      another space. \e len when there is none.
+    */
+    if ( from >= len ){
+      return len;
+    }
+#ifdef FOLIA_X86_SIMD
+    switch ( simd_level() ){
+    case SIMD_LEVEL::AVX2:
+      return skip_plain_ascii_avx2( buf, len, from );
+    case SIMD_LEVEL::SSE2:
+      return skip_plain_ascii_sse2( buf, len, from );
+    default:
+      break;
+    }
+#endif
+    return skip_plain_ascii_scalar( buf, len, from );
+  }
+
+} // namespace folia
@@ -37,12 +37,14 @@
 #include <algorithm>
 #include <type_traits>
 #include <stdexcept>
+#include <mutex>
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/StringOps.h"
 #include "ticcutils/XMLtools.h"
 #include "ticcutils/Unicode.h"
 #include "libfolia/folia.h"
 #include "libfolia/folia_properties.h"
+#include "libfolia/folia_simd.h"
 #include "config.h"
 
 using namespace std;
@@ -529,10 +531,10 @@ namespace folia {
     int depth = 0;
     FoliaElement *p = parent();
     while ( p ){
-      if ( ( p->isSubClass<String>()
-	     || p->isSubClass<AbstractWord>()
-	     || p->isSubClass<AbstractStructureElement>()
-	     || p->isSubClass<AbstractSubtokenAnnotation>( ) )
+      if ( ( p->is_a( ElementType::String_t )
+	     || p->is_a( ElementType::AbstractWord_t )
+	     || p->is_a( ElementType::AbstractStructureElement_t )
+	     || p->is_a( ElementType::AbstractSubtokenAnnotation_t ) )
 	   && p->acceptable<TextContent>() ){
 	if ( ++depth == 2 ){
 	  return p;
@@ -710,8 +712,8 @@ namespace folia {
     int depth = 0;
     FoliaElement *p = parent();
     while ( p ){
-      if ( p->isSubClass<AbstractStructureElement>()
-	   || p->isSubClass<AbstractSubtokenAnnotation>() ){
+      if ( p->is_a( ElementType::AbstractStructureElement_t )
+	   || p->is_a( ElementType::AbstractSubtokenAnnotation_t ) ){
 	if ( ++depth == 2 ){
 	  return p;
 	}
@@ -883,9 +885,18 @@ namespace folia {
      * children in the default_ignore_structure set, like Alternative, Foreign
      * and the Original and Suggestion parts of Correction
      */
-    vector<Sentence*> v = sentences();
-    if ( index < v.size() ) {
-      return v[index];
+    Sentence *result = 0;
+    size_t count = 0;
+    for_each<Sentence>( [&]( Sentence *sent ){
+	if ( count++ == index ){
+	  result = sent;
+	  return false;
+	}
+	return true;
+      },
+      default_ignore_structure );
+    if ( result ){
+      return result;
     }
     throw range_error( "sentences(): index out of range" );
   }
@@ -915,9 +926,18 @@ namespace folia {
      * children in the default_ignore_structure set, like Alternative, Foreign
      * and the Original and Suggestion parts of Correction
      */
-    vector<Paragraph*> v = paragraphs();
-    if ( index < v.size() ) {
-      return v[index];
+    Paragraph *result = 0;
+    size_t count = 0;
+    for_each<Paragraph>( [&]( Paragraph *par ){
+	if ( count++ == index ){
+	  result = par;
+	  return false;
+	}
+	return true;
+      },
+      default_ignore_structure );
+    if ( result ){
+      return result;
     }
     throw range_error( "paragraphs(): index out of range" );
   }
@@ -949,9 +969,18 @@ namespace folia {
      * children in the default_ignore_structure set, like Alternative, Foreign
      * and the Original and Suggestion parts of Correction
      */
-    vector<Word*> v = words(st);
-    if ( index < v.size() ) {
-      return v[index];
+    Word *result = 0;
+    size_t count = 0;
+    for_each<Word>( [&]( Word *word ){
+	if ( count++ == index ){
+	  result = word;
+	  return false;
+	}
+	return true;
+      },
+      st, default_ignore_structure );
+    if ( result ){
+      return result;
     }
     throw range_error( "words(): index out of range" );
   }
@@ -1136,7 +1165,7 @@ namespace folia {
      * will throw on error
      * checks uniqueness of the child when it is an annotation
      */
-    if ( child->isSubClass<AbstractAnnotationLayer>() ) {
+    if ( child->is_a( ElementType::AbstractAnnotationLayer_t ) ) {
       // sanity check, there may be no other child within the same set
       vector<FoliaElement*> v = select( child->element_id(), child->sett() );
       if ( v.empty() ) {
@@ -1242,46 +1271,99 @@ namespace folia {
     return 0;
   }
 
-  Word *Word::previous() const {
-    /// return the previous Word in the Sentence
+  static bool is_inside( const FoliaElement *el, const FoliaElement *anc ){
+    /// is anc one of the ancestors of el?
+    for ( const FoliaElement *p = el->parent(); p; p = p->parent() ){
+      if ( p == anc ){
+	return true;
+      }
+    }
+    return false;
+  }
+
+  static Word *sentence_neighbour( const Word *word, bool forward ){
+    /// return the previous or next Word within the Sentence of word
     /*!
-     * \return the previous Word or 0, when not found.
-     */
-    Sentence *s = sentence();
-    vector<Word*> words = s->words();
-    for ( size_t i=0; i < words.size(); ++i ) {
-      if ( words[i] == this ) {
-	if ( i > 0 ) {
-	  return words[i-1];
+     * \param word the Word to start from
+     * \param forward when true, look for the next Word, otherwise for the
+     * previous one
+     * \return the Word found or 0, when word is the first/last one
+     *
+     * The Words of a Sentence form a contiguous stretch of the Document's
+     * words(), so we only have to look at the direct neighbour there. Words
+     * that are not in that list, fall back to scanning the Sentence. So do
+     * all Words when Words were added or removed since the list was built:
+     * rebuilding it costs a walk over the whole Document, so a loop that
+     * adds Words while walking with next() would become quadratic.
+     */
+    Sentence *s = word->sentence();
+    const Document *doc = word->doc();
+    if ( doc && !doc->word_index_outdated() ){
+      size_t count = doc->word_count();
+      size_t pos = doc->word_position( word );
+      if ( pos < count ){
+	if ( forward ){
+	  ++pos;
 	}
-	else {
+	else if ( pos == 0 ){
 	  return 0;
 	}
-	break;
+	else {
+	  --pos;
+	}
+	if ( pos < count ){
+	  Word *result = doc->words( pos );
+	  if ( is_inside( result, s ) ){
+	    return result;
+	  }
+	}
+	return 0;
+      }
+    }
+    vector<Word*> words = s->words();
+    for ( size_t i=0; i < words.size(); ++i ) {
+      if ( words[i] == word ) {
+	if ( forward ){
+	  return ( i+1 < words.size() ) ? words[i+1] : 0;
+	}
+	return ( i > 0 ) ? words[i-1] : 0;
       }
     }
     return 0;
   }
 
+  Word *Word::previous() const {
+    /// return the previous Word in the Sentence
+    /*!
+     * \return the previous Word or 0, when not found.
+     */
+    return sentence_neighbour( this, false );
+  }
+
   Word *Word::next() const{
     /// return the next Word in the Sentence
     /*!
      * \return the next Word or 0, when not found.
      */
-    Sentence *s = sentence();
-    vector<Word*> words = s->words();
-    for ( size_t i=0; i < words.size(); ++i ) {
-      if ( words[i] == this ) {
-	if ( i+1 < words.size() ) {
-	  return words[i+1];
-	}
-	else {
-	  return 0;
-	}
-	break;
-      }
+    return sentence_neighbour( this, true );
+  }
+
+  static Word *context_filler( Document *doc, const string& val ){
+    /// return a filler for a context position without a Word
+    /*!
+     * \param doc the Document that will take ownership of the placeholder
+     * \param val string value of the placeholder
+     * \return 0 when val is empty, otherwise a new placeholder Word
+     */
+    if ( val.empty() ) {
+      return 0;
     }
-    return 0;
+    KWargs args;
+    args.add("text",val);
+    args.add("placeholder","yes");
+    Word *p = new Word( args );
+    doc->keepForDeletion( p );
+    return p;
   }
 
   vector<Word*> Word::context( size_t size,
@@ -1298,45 +1380,23 @@ namespace folia {
      */
     vector<Word*> result;
     if ( size > 0 ) {
-      vector<Word*> words = doc()->words();
-      for ( size_t i=0; i < words.size(); ++i ) {
-	if ( words[i] == this ) {
-	  size_t miss = 0;
-	  if ( i < size ) {
-	    miss = size - i;
-	  }
-	  for ( size_t index=0; index < miss; ++index ) {
-	    if ( val.empty() ) {
-	      result.push_back( 0 );
-	    }
-	    else {
-	      KWargs args;
-	      args.add("text",val);
-	      args.add("placeholder","yes");
-	      Word *p = new Word( args );
-	      doc()->keepForDeletion( p );
-	      result.push_back( p );
-	    }
+      size_t count = doc()->word_count();
+      size_t i = doc()->word_position( this );
+      if ( i < count ) {
+	size_t miss = 0;
+	if ( i < size ) {
+	  miss = size - i;
+	}
+	for ( size_t index=0; index < miss; ++index ) {
+	  result.push_back( context_filler( doc(), val ) );
+	}
+	for ( size_t index=i-size+miss; index < i + size + 1; ++index ) {
+	  if ( index < count ) {
+	    result.push_back( doc()->words( index ) );
 	  }
-	  for ( size_t index=i-size+miss; index < i + size + 1; ++index ) {
-	    if ( index < words.size() ) {
-	      result.push_back( words[index] );
-	    }
-	    else {
-	      if ( val.empty() ) {
-		result.push_back( 0 );
-	      }
-	      else {
-		KWargs args;
-		args.add("text",val);
-		args.add("placeholder","yes");
-		Word *p = new Word( args );
-		doc()->keepForDeletion( p );
-		result.push_back( p );
-	      }
-	    }
+	  else {
+	    result.push_back( context_filler( doc(), val ) );
 	  }
-	  break;
 	}
       }
     }
@@ -1359,30 +1419,18 @@ namespace folia {
     //  DBG << "leftcontext : " << size << endl;
     vector<Word*> result;
     if ( size > 0 ) {
-      vector<Word*> words = doc()->words();
-      for ( size_t i=0; i < words.size(); ++i ) {
-	if ( words[i] == this ) {
-	  size_t miss = 0;
-	  if ( i < size ) {
-	    miss = size - i;
-	  }
-	  for ( size_t index=0; index < miss; ++index ) {
-	    if ( val.empty() ) {
-	      result.push_back( 0 );
-	    }
-	    else {
-	      KWargs args;
-	      args.add("text",val);
-	      args.add("placeholder","yes");
-	      Word *p = new Word( args );
-	      doc()->keepForDeletion( p );
-	      result.push_back( p );
-	    }
-	  }
-	  for ( size_t index=i-size+miss; index < i; ++index ) {
-	    result.push_back( words[index] );
-	  }
-	  break;
+      size_t count = doc()->word_count();
+      size_t i = doc()->word_position( this );
+      if ( i < count ) {
+	size_t miss = 0;
+	if ( i < size ) {
+	  miss = size - i;
+	}
+	for ( size_t index=0; index < miss; ++index ) {
+	  result.push_back( context_filler( doc(), val ) );
+	}
+	for ( size_t index=i-size+miss; index < i; ++index ) {
+	  result.push_back( doc()->words( index ) );
 	}
       }
     }
@@ -1404,31 +1452,18 @@ namespace folia {
     vector<Word*> result;
     //  DBG << "rightcontext : " << size << endl;
     if ( size > 0 ) {
-      vector<Word*> words = doc()->words();
-      size_t begin;
-      size_t end;
-      for ( size_t i=0; i < words.size(); ++i ) {
-	if ( words[i] == this ) {
-	  begin = i + 1;
-	  end = begin + size;
-	  for ( ; begin < end; ++begin ) {
-	    if ( begin >= words.size() ) {
-	      if ( val.empty() ) {
-		result.push_back( 0 );
-	      }
-	      else {
-		KWargs args;
-		args.add("text",val);
-		args.add("placeholder","yes");
-		Word *p = new Word( args );
-		doc()->keepForDeletion( p );
-		result.push_back( p );
-	      }
-	    }
-	    else
-	      result.push_back( words[begin] );
+      size_t count = doc()->word_count();
+      size_t i = doc()->word_position( this );
+      if ( i < count ) {
+	size_t begin = i + 1;
+	size_t end = begin + size;
+	for ( ; begin < end; ++begin ) {
+	  if ( begin >= count ) {
+	    result.push_back( context_filler( doc(), val ) );
+	  }
+	  else {
+	    result.push_back( doc()->words( begin ) );
 	  }
-	  break;
 	}
       }
     }
@@ -1447,6 +1482,35 @@ namespace folia {
     return 0;
   }
 
+  static vector<AbstractSpanAnnotation*> findspans_scan( const FoliaElement *word,
+							 const FoliaElement *parent,
+							 ElementType layertype,
+							 const string& st ){
+    /// find the spans of a word by scanning the layers of its parent
+    /*!
+     * Used for Words that aren't part of a Document yet, and after a change
+     * of the spans in the Document: rebuilding the index of all spans
+     * (see Document::spans_of()) is much more work than this scan.
+     */
+    vector<AbstractSpanAnnotation *> result;
+    const vector<FoliaElement*> v
+      = parent->select( layertype, st, SELECT_FLAGS::LOCAL );
+    for ( const auto* const el : v ){
+      for ( size_t k=0; k < el->size(); ++k ) {
+	FoliaElement *f = el->index(k);
+	if ( f->is_a( ElementType::AbstractSpanAnnotation_t ) ) {
+	  AbstractSpanAnnotation *span = dynamic_cast<AbstractSpanAnnotation*>(f);
+	  for ( const auto *const wr : span->wrefs_view() ){
+	    if ( wr == word ) {
+	      result.push_back( span );
+	    }
+	  }
+	}
+      }
+    }
+    return result;
+  }
+
   vector<AbstractSpanAnnotation*> AbstractWord::findspans( ElementType et,
 							   const string& st ) const {
     /// find all SpanAnnotation nodes of this object for a given type
@@ -1460,21 +1524,17 @@ namespace folia {
     if ( layertype != ElementType::BASE ) {
       const FoliaElement *e = parent();
       if ( e ) {
-	const vector<FoliaElement*> v
-	  = e->select( layertype, st, SELECT_FLAGS::LOCAL );
-	for ( const auto* const el : v ){
-	  for ( size_t k=0; k < el->size(); ++k ) {
-	    FoliaElement *f = el->index(k);
-	    AbstractSpanAnnotation *as
-	      = dynamic_cast<AbstractSpanAnnotation*>(f);
-	    if ( as ) {
-	      const vector<FoliaElement*> wrefv = f->wrefs();
-	      for ( const auto *const wr : wrefv ){
-		if ( wr == this ) {
-		  result.push_back(as);
-		}
-	      }
-	    }
+	if ( !doc() || doc()->span_index_outdated() ){
+	  return findspans_scan( this, e, layertype, st );
+	}
+	// only the spans directly in a matching layer of our parent count
+	for ( const auto& span : doc()->spans_of( this ) ){
+	  const FoliaElement *layer = span->parent();
+	  if ( layer
+	       && layer->parent() == e
+	       && layer->element_id() == layertype
+	       && ( st.empty() || layer->sett() == st ) ){
+	    result.push_back( span );
 	  }
 	}
       }
@@ -1493,7 +1553,7 @@ namespace folia {
     if ( !AbstractElement::addable( parent ) ){
       return false;
     }
-    if ( parent->isSubClass<AbstractSpanRole>() ){
+    if ( parent->is_a( ElementType::AbstractSpanRole_t ) ){
       // we should check the textclass of the layer above this.
       // but due to recursion, it is not connected to that layer yet!
       // this is checked later in AbstractSpanRole::addable( )
@@ -1554,6 +1614,17 @@ namespace folia {
     return this;
   }
 
+  const UnicodeString WordReference::private_text( const TextPolicy& tp ) const {
+    /// return the text of the referenced node
+    /*!
+     * \param tp the TextPolicy to use
+     * This text lives elsewhere in the tree, so the text of our ancestors
+     * must not be cached.
+     */
+    mark_text_uncachable();
+    return _reference->private_text( tp );
+  }
+
   xmlNode *WordReference::xml( bool, bool ) const {
     ///  convert the WordReference to an xmlNode
     xmlNode *e = AbstractElement::xml( false, false );
@@ -1746,6 +1817,7 @@ namespace folia {
       }
     }
     AbstractElement::append( child );
+    invalidate_wrefs();
     if ( child->isinstance<Word>()
 	 && dynamic_cast<Word*>(child)->is_placeholder() ) {
       child->increfcount();
@@ -1753,13 +1825,46 @@ namespace folia {
     return child;
   }
 
+  void AbstractSpanAnnotation::remove( FoliaElement *child ){
+    /// remove a child from an AbstractSpanAnnotation
+    /*!
+     * \param child the element to remove
+     */
+    AbstractElement::remove( child );
+    invalidate_wrefs();
+  }
+
+  FoliaElement* AbstractSpanAnnotation::replace( FoliaElement *old,
+						 FoliaElement* _new ){
+    /// replace in the children of an AbstractSpanAnnotation old by _new
+    /*!
+     * \param old The node to be replacec
+     * \param _new the new node to add
+     * \return old, or 0 when old is not found
+     */
+    FoliaElement *result = AbstractElement::replace( old, _new );
+    invalidate_wrefs();
+    return result;
+  }
+
+  void AbstractSpanAnnotation::insert_after( FoliaElement *pos,
+					     FoliaElement *add ){
+    /// insert a node in an AbstractSpanAnnotation after a certain element
+    /*!
+     * \param pos The location after which to insert add
+     * \param add the element to add
+     */
+    AbstractElement::insert_after( pos, add );
+    invalidate_wrefs();
+  }
+
   void AbstractAnnotationLayer::assignset( const FoliaElement *child ) {
     // If there is no set (yet), try to get the set from the child
     // but not if it is the default set.
     // for a Correction child, we look deeper.
     // BARF when the sets are incompatible.
     string c_set;
-    if ( child->isSubClass<AbstractSpanAnnotation>() ) {
+    if ( child->is_a( ElementType::AbstractSpanAnnotation_t ) ) {
       string st = child->sett();
       if ( !st.empty()
 	   && doc()->default_set( child->annotation_type() ) != st ) {
@@ -1771,7 +1876,7 @@ namespace folia {
       if ( org ) {
 	for ( size_t i=0; i < org->size(); ++i ) {
 	  const FoliaElement *el = org->index(i);
-	  if ( el->isSubClass<AbstractSpanAnnotation>() ) {
+	  if ( el->is_a( ElementType::AbstractSpanAnnotation_t ) ) {
 	    string st = el->sett();
 	    if ( !st.empty()
 		 && doc()->default_set( el->annotation_type() ) != st ) {
@@ -1786,7 +1891,7 @@ namespace folia {
 	if ( nw ) {
 	  for ( size_t i=0; i < nw->size(); ++i ) {
 	    const FoliaElement *el = nw->index(i);
-	    if ( el->isSubClass<AbstractSpanAnnotation>() ) {
+	    if ( el->is_a( ElementType::AbstractSpanAnnotation_t ) ) {
 	      string st = el->sett();
 	      if ( !st.empty()
 		   && doc()->default_set( el->annotation_type() ) != st ) {
@@ -1801,7 +1906,7 @@ namespace folia {
 	// false positive. c_set can be changed in previous for loop
 	auto v = child->suggestions();
 	for ( const auto* el : v ) {
-	  if ( el->isSubClass<AbstractSpanAnnotation>() ) {
+	  if ( el->is_a( ElementType::AbstractSpanAnnotation_t ) ) {
 	    string st = el->sett();
 	    if ( !st.empty()
 		 && doc()->default_set( el->annotation_type() ) != st ) {
@@ -2680,31 +2785,47 @@ namespace folia {
     return v[0];
   }
 
-  vector<FoliaElement*> AbstractSpanAnnotation::wrefs() const {
-    /// select all referable Elements present in this object
+  static recursive_mutex wrefs_mutex; // serializes filling the wrefs() caches
+
+  const vector<FoliaElement*>& AbstractSpanAnnotation::wrefs_view() const {
+    /// give read-only access to all referable Elements present in this object
     /*!
-     * \return al list of FoliAElements
+     * \return a reference to the cached list. It stays valid until the
+     * children of this span (or of a span nested in it) change.
      * recurses through al the children to look for referable nodes
      * (see WREFABLE) and collects them in one list.
      */
-    vector<FoliaElement*> res;
-    for ( const auto& el : data() ) {
-      if ( el->isinstance<WordReference>() ){
-	res.push_back( dynamic_cast<WordReference*>(el)->_reference );
-      }
-      else if ( el->referable() ){
-	res.push_back( el );
-      }
-      else {
-	const AbstractSpanAnnotation *as
-	  = dynamic_cast<AbstractSpanAnnotation*>(el);
-	if ( as != 0 ) {
-	  vector<FoliaElement*> sub = as->wrefs();
-	  copy( sub.begin(), sub.end(), back_inserter(res) );
+    if ( !_wrefs_valid.load( memory_order_acquire ) ){
+      lock_guard<recursive_mutex> lock( wrefs_mutex );
+      if ( !_wrefs_valid.load( memory_order_relaxed ) ){
+	_wrefs.clear();
+	for ( const auto& el : data() ) {
+	  if ( el->isinstance<WordReference>() ){
+	    _wrefs.push_back( dynamic_cast<WordReference*>(el)->ref() );
+	  }
+	  else if ( el->referable() ){
+	    _wrefs.push_back( el );
+	  }
+	  else if ( el->is_a( ElementType::AbstractSpanAnnotation_t ) ) {
+	    const vector<FoliaElement*>& sub
+	      = dynamic_cast<const AbstractSpanAnnotation*>(el)->wrefs_view();
+	    _wrefs.insert( _wrefs.end(), sub.begin(), sub.end() );
+	  }
 	}
+	_wrefs_valid.store( true, memory_order_release );
       }
     }
-    return res;
+    return _wrefs;
+  }
+
+  vector<FoliaElement*> AbstractSpanAnnotation::wrefs() const {
+    /// select all referable Elements present in this object
+    /*!
+     * \return al list of FoliAElements
+     * recurses through al the children to look for referable nodes
+     * (see WREFABLE) and collects them in one list.
+     */
+    return wrefs_view();
   }
 
   FoliaElement *AbstractSpanAnnotation::wrefs( size_t pos ) const {
@@ -2714,13 +2835,66 @@ namespace folia {
      * recurses through al the children to look for referable nodes
      * (see WREFABLE) and collects them in one list.
      */
-    vector<FoliaElement*> v = wrefs();
+    const vector<FoliaElement*>& v = wrefs_view();
     if ( pos < v.size() ) {
       return v[pos];
     }
     return 0;
   }
 
+  void AbstractSpanAnnotation::invalidate_wrefs(){
+    /// forget the cached wrefs() of this span and the spans it is part of
+    FoliaElement *p = this;
+    while ( p && p->is_a( ElementType::AbstractSpanAnnotation_t ) ){
+      dynamic_cast<AbstractSpanAnnotation*>(p)->_wrefs_valid.store( false,
+								     memory_order_relaxed );
+      p = p->parent();
+    }
+  }
+
+  static bool selectable_below( const FoliaElement *el,
+			       const FoliaElement *top ){
+    /// would top->select() reach el, using default_ignore?
+    for ( const FoliaElement *p = el->parent(); p; p = p->parent() ){
+      if ( p == top ){
+	return true;
+      }
+      if ( default_ignore.find( p->element_id() ) != default_ignore.end() ){
+	return false;
+      }
+    }
+    return false;
+  }
+
+  static AbstractSpanAnnotation *findspan_indexed( const FoliaElement *layer,
+						   const vector<FoliaElement*>& words ){
+    /// find the span in layer with exactly the given wrefs, using the
+    /// reverse index of the Document
+    /*!
+     * \param layer the layer to search
+     * \param words the (non-empty) list of words
+     * \return the spanning element, or 0 if not found.
+     *
+     * Only the spans that refer to the first word are candidates. When
+     * several match, we prefer the one selectSpan() would return first:
+     * the lowest ElementType (SpanSet is ordered), then document order.
+     */
+    AbstractSpanAnnotation *result = 0;
+    for ( const auto& span : layer->doc()->spans_of( words[0] ) ){
+      if ( result && span->element_id() >= result->element_id() ){
+	continue;
+      }
+      if ( SpanSet.find( span->element_id() ) == SpanSet.end()
+	   || !selectable_below( span, layer ) ){
+	continue;
+      }
+      if ( span->wrefs_view() == words ){
+	result = span;
+      }
+    }
+    return result;
+  }
+
   AbstractSpanAnnotation *AbstractAnnotationLayer::findspan( const vector<FoliaElement*>& words ) const {
     /// find the SpanAnnotation which spans the whole list of words
     /*!
@@ -2729,9 +2903,12 @@ namespace folia {
      * All available SpanAnnotations are search for one that spans EXACTLY
      * the 'words' list
      */
+    if ( !words.empty() && doc() && !doc()->span_index_outdated() ){
+      return findspan_indexed( this, words );
+    }
     vector<AbstractSpanAnnotation*> av = selectSpan();
     for ( const auto& span : av ){
-      vector<FoliaElement*> v = span->wrefs();
+      const vector<FoliaElement*>& v = span->wrefs_view();
       if ( v.size() == words.size() ) {
 	bool ok = true;
 	for ( size_t n = 0; n < v.size(); ++n ) {
@@ -2749,16 +2926,47 @@ namespace folia {
   }
 
   UnicodeString dumb_spaces( const UnicodeString& is ){
+    /// replace all 'exotic' whitespace by a plain space
+    /*!
+     * \param is the UnicodeString to clean
+     * \return is, with all whitespace except tab, newline and carriage return
+     * replaced by a space.
+     *
+     * ASCII is checked without consulting ICU, and a string without exotic
+     * whitespace (by far the most common case) is returned as is. Runs of
+     * printable ASCII are skipped with skip_ascii_range(), which uses SSE2
+     * or AVX2 when available.
+     */
+    auto is_dumb = []( UChar c ){
+      if ( c < 0x0080 ){
+	// only these ASCII characters are u_isspace() too
+	return ( c == 0x000b || c == 0x000c
+		 || ( c >= 0x001c && c <= 0x001f ) );
+      }
+      return bool( u_isspace( c ) );
+    };
+    const int len = is.length();
+    const UChar *buf = is.getBuffer();
+    int i = 0;
+    while ( ( i = skip_ascii_range( buf, len, i, 0x0020, 0x007e ) ) < len
+	    && !is_dumb( buf[i] ) ){
+      ++i;
+    }
+    if ( i == len ){
+      return is;
+    }
     UnicodeString os;
-    for ( int i=0; i < is.length(); ++i ){
-      if ( u_isspace( is[i] )
-	   && !( ( is[i] == '\t' ) || is[i] == '\n' || is[i] == '\r' ) ){
-	os += " ";
-      }
-      else {
-	os += is[i];
+    UChar *out = os.getBuffer( len );
+    if ( !out ){
+      throw bad_alloc();
+    }
+    copy( buf, buf+len, out );
+    for ( ; i < len; ++i ){
+      if ( is_dumb( buf[i] ) ){
+	out[i] = 0x0020;
       }
     }
+    os.releaseBuffer( len );
     return os;
   }
 
@@ -2767,6 +2975,7 @@ namespace folia {
      * \param us a Unicode string
      */
     _value = TiCC::UnicodeToUTF8( us );
+    tree_changed( this );
   }
 
   void XmlText::setvalue( const string& s ){
@@ -2778,6 +2987,7 @@ namespace folia {
       UnicodeString us = TiCC::UnicodeFromUTF8(s);
       us = dumb_spaces( us );
       _value = TiCC::UnicodeToUTF8( us );
+      tree_changed( this );
     }
   }
 
@@ -30,6 +30,9 @@
 #include <map>
 #include <set>
 #include <list>
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
 #include "ticcutils/StringOps.h"
 #include "libfolia/folia_properties.h"
 #include "libfolia/folia.h"
@@ -127,24 +130,133 @@ namespace folia {
     return result->second;
   }
 
-  ElementType stringToElementType( const string& intag ){
+  /// a perfect hash table over the FoLiA tag vocabulary
+  /*!
+    Holds all tags from s_et_map and the 'old' pre v1.5 names from oldtags.
+    It uses 'hash and displace': the first hash selects a bucket, the
+    displacement stored for that bucket seeds a second hash which gives the
+    slot. The displacements are searched for when the table is built, such
+    that no two tags share a slot. A lookup is then two hashes and one string
+    compare.
+  */
+  class tag_table {
+  public:
+    tag_table();
+    bool lookup( string_view, ElementType& ) const;
+  private:
+    static uint32_t hash( string_view, uint32_t );
+    vector<uint32_t> _displacements;
+    vector<pair<string,ElementType>> _slots;
+  };
+
+  uint32_t tag_table::hash( string_view tag, uint32_t seed ){
+    /// FNV-1a, with the seed mixed into the offset basis
+    uint32_t h = 2166136261u ^ ( seed * 0x9E3779B9u );
+    for ( const auto c : tag ){
+      h ^= static_cast<unsigned char>(c);
+      h *= 16777619u;
+    }
+    return h;
+  }
+
+  tag_table::tag_table(){
+    map<string,ElementType> all_tags = s_et_map;
+    for ( const auto& [old_tag,new_tag] : oldtags ){
+      all_tags[old_tag] = s_et_map.at( new_tag );
+    }
+    vector<pair<string,ElementType>> tags( all_tags.begin(), all_tags.end() );
+    size_t size = 1;
+    while ( size < 2*tags.size() ){
+      size *= 2;
+    }
+    _slots.resize( size, make_pair( string(), ElementType::BASE ) );
+    _displacements.resize( tags.size()/4 + 1, 0 );
+    vector<vector<size_t>> buckets( _displacements.size() );
+    for ( size_t i=0; i < tags.size(); ++i ){
+      buckets[hash( tags[i].first, 0 ) % buckets.size()].push_back( i );
+    }
+    // place the largest buckets first, while most slots are still free
+    vector<size_t> order( buckets.size() );
+    for ( size_t b=0; b < order.size(); ++b ){
+      order[b] = b;
+    }
+    stable_sort( order.begin(), order.end(),
+		 [&buckets]( size_t b1, size_t b2 ){
+		   return buckets[b1].size() > buckets[b2].size(); } );
+    vector<bool> used( size, false );
+    vector<size_t> slots;
+    for ( const auto b : order ){
+      if ( buckets[b].empty() ){
+	break;
+      }
+      for ( uint32_t disp = 1; ; ++disp ){
+	slots.clear();
+	for ( const auto i : buckets[b] ){
+	  size_t slot = hash( tags[i].first, disp ) & ( size - 1 );
+	  if ( used[slot]
+	       || find( slots.begin(), slots.end(), slot ) != slots.end() ){
+	    break;
+	  }
+	  slots.push_back( slot );
+	}
+	if ( slots.size() == buckets[b].size() ){
+	  for ( size_t j=0; j < slots.size(); ++j ){
+	    used[slots[j]] = true;
+	    _slots[slots[j]] = tags[buckets[b][j]];
+	  }
+	  _displacements[b] = disp;
+	  break;
+	}
+      }
+    }
+  }
+
+  bool tag_table::lookup( string_view tag, ElementType& et ) const {
+    /// lookup tag in the table
+    /*!
+      \param tag the tag to search for
+      \param et the ElementType found
+      \return true when found
+    */
+    if ( tag.empty() ){
+      return false;
+    }
+    uint32_t disp = _displacements[hash( tag, 0 ) % _displacements.size()];
+    if ( disp == 0 ){
+      return false;
+    }
+    const auto& slot = _slots[hash( tag, disp ) & ( _slots.size() - 1 )];
+    if ( slot.first == tag ){
+      et = slot.second;
+      return true;
+    }
+    return false;
+  }
+
+  static const tag_table& the_tag_table(){
+    /// the table is built on first use, after s_et_map is initialized
+    static const tag_table table;
+    return table;
+  }
+
+  ElementType stringToElementType( string_view tag ){
     // convert a string into an ElementType
     /*!
-     * \param intag a string representing an ElementType
+     * \param tag a string representing an ElementType
      * \return an ElementType. Throws when not found.
      *
      * Also handles 'old' pre v1.5 names.
      */
-    string tag = intag;
-    auto const tr = oldtags.find(intag);
-    if ( tr != oldtags.end() ){
-      tag = tr->second;
-    }
-    auto result = s_et_map.find(tag);
-    if ( result == s_et_map.end() ){
-      throw ValueError( "unknown tag <" + tag + ">" );
+    ElementType result;
+    if ( !the_tag_table().lookup( tag, result ) ){
+      throw ValueError( "unknown tag <" + string(tag) + ">" );
     }
-    return result->second;
+    return result;
+  }
+
+  ElementType stringToElementType( const string& tag ){
+    /// convert a string into an ElementType. See the string_view version
+    return stringToElementType( string_view( tag ) );
   }
 
   string toString( const Attrib at ){
@@ -33,18 +33,26 @@
 #include <map>
 #include <set>
 #include <list>
+#include <unordered_set>
+#include <unordered_map>
+#include <shared_mutex>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <netdb.h>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
+#include <thread>
+#include <fstream>
+#include <sys/stat.h>
 #include "ticcutils/StringOps.h"
 #include "ticcutils/XMLtools.h"
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/Unicode.h"
 #include "libfolia/folia.h"
 #include "libfolia/folia_properties.h"
+#include "libfolia/folia_simd.h"
 
 using namespace std;
 using namespace icu;
@@ -139,13 +147,114 @@ namespace folia {
       \param doc the Document the new element will be part of. May be 0
       \return a new FoliaElement
     */
+    ElementArena::scope arena( doc ? doc->element_arena() : 0 );
     FoliaElement *el = private_createElement( et );
     if ( doc ){
-      el->assignDoc( doc );
+      try {
+	el->assignDoc( doc );
+      }
+      catch ( ... ){
+	// e.g. a missing declaration. el is still bare, no need to destroy()
+	delete el;
+	throw;
+      }
     }
     return el;
   }
 
+  const interned_string::entry interned_string::empty_entry( "" );
+
+  unordered_map<string_view,const interned_string::entry*>&
+  interned_string::string_pool(){
+    /// the pool of all interned strings in use, keyed on their value
+    /*!
+      The map itself is never deleted, so handles in objects that are
+      destroyed at program exit can still use it.
+    */
+    static auto *pool = new unordered_map<string_view,const entry*>();
+    return *pool;
+  }
+
+  static shared_mutex string_pool_lock;
+
+  const interned_string::entry *interned_string::intern( const string& s ){
+    /// return the pooled entry for \e s, adding it when it is new
+    /*!
+      \param s the string to intern
+      \return a pointer to the pooled entry, with one more reference
+    */
+    if ( s.empty() ){
+      return &empty_entry;
+    }
+    {
+      // while we hold the lock, release() cannot remove the entry
+      shared_lock<shared_mutex> guard( string_pool_lock );
+      auto it = string_pool().find( s );
+      if ( it != string_pool().end() ){
+	acquire( it->second );
+	return it->second;
+      }
+    }
+    unique_lock<shared_mutex> guard( string_pool_lock );
+    auto it = string_pool().find( s );
+    if ( it != string_pool().end() ){
+      acquire( it->second );
+      return it->second;
+    }
+    const entry *e = new entry( s );
+    string_pool().emplace( e->value, e );
+    return e;
+  }
+
+  void interned_string::release( const entry *e ){
+    /// drop a reference to a pooled entry, removing it after the last one
+    /*!
+      \param e the entry
+      Only the last reference is dropped under the pool lock. So intern()
+      can never hand out an entry that is being removed.
+    */
+    if ( e == &empty_entry ){
+      return;
+    }
+    size_t refs = e->refs.load( memory_order_relaxed );
+    while ( refs > 1 ){
+      if ( e->refs.compare_exchange_weak( refs, refs-1,
+					  memory_order_release,
+					  memory_order_relaxed ) ){
+	return;
+      }
+    }
+    unique_lock<shared_mutex> guard( string_pool_lock );
+    if ( e->refs.fetch_sub( 1, memory_order_acq_rel ) == 1 ){
+      string_pool().erase( e->value );
+      delete e;
+    }
+  }
+
+  const string *interned_string::lookup( const string& s ){
+    /// return the pooled copy of \e s, if any
+    /*!
+      \param s the string to look up
+      \return a pointer to the pooled value, or 0 when \e s is not in use.
+      So no interned_string has that value now.
+    */
+    if ( s.empty() ){
+      return &empty_entry.value;
+    }
+    shared_lock<shared_mutex> guard( string_pool_lock );
+    auto it = string_pool().find( s );
+    if ( it != string_pool().end() ){
+      return &it->second->value;
+    }
+    return 0;
+  }
+
+  size_t interned_string::pool_size(){
+    /// return the number of different strings in the pool
+    shared_lock<shared_mutex> guard( string_pool_lock );
+    return string_pool().size();
+  }
+
   KWargs::KWargs( const string& s ){
     /// create a KWargs from an input string
     /*!
@@ -337,7 +446,7 @@ namespace folia {
     string result;
     auto it = find(att);
     if ( it != end() ){
-      result = it->second;
+      result = std::move( it->second );
       erase(it);
     }
     return result;
@@ -375,14 +484,110 @@ namespace folia {
     return folia::toString( *this );
   }
 
-  inline string att_name( const xmlAttr *node ){
-    return to_string( node->name );
-  }
-
   inline string att_content( const xmlAttr *node ){
     return TextValue( node->children );
   }
 
+  bool attribute_bag::add( string_view att, string_view val ){
+    /// add an attribute/value pair, like KWargs::add() does
+    /*!
+      \param att name of the attribute
+      \param val the value of the attribute
+      \return false if nothing is added, because att or val is empty.
+      Throws when att is already present
+      Both views must stay valid as long as the bag is used.
+    */
+    if ( att.empty() || val.empty() ){
+      return false;
+    }
+    if ( !lookup( att ).empty() ){
+      throw DuplicateAttributeError( to_kwargs(), string( att ),
+				     string( val ) );
+    }
+    if ( _size < INLINE_SIZE ){
+      _inline[_size] = make_pair( att, val );
+    }
+    else {
+      if ( _size == INLINE_SIZE ){
+	_spill.assign( _inline.begin(), _inline.end() );
+      }
+      _spill.emplace_back( att, val );
+    }
+    ++_size;
+    return true;
+  }
+
+  string_view attribute_bag::keep( string&& s ){
+    /// store a string that is not part of the xml tree in the bag
+    /*!
+      \param s the string to keep
+      \return a view on the kept string, valid as long as the bag
+    */
+    _kept.push_front( std::move( s ) );
+    return _kept.front();
+  }
+
+  string_view attribute_bag::lookup( string_view att ) const {
+    /// lookup an attribute
+    /*!
+      \param att The attribute to check
+      \return the value if present, otherwise an empty view
+    */
+    for ( const auto& [at,val] : *this ){
+      if ( at == att ){
+	return val;
+      }
+    }
+    return string_view();
+  }
+
+  KWargs attribute_bag::to_kwargs() const {
+    /// copy the attributes and values to a new KWargs
+    KWargs result;
+    for ( const auto& [at,val] : *this ){
+      result.emplace_hint( result.end(), at, val );
+    }
+    return result;
+  }
+
+  void getAttributes( const xmlNode *node, attribute_bag& atts ){
+    /// collect the attributes of an xmlNode in an attribute_bag
+    /*!
+      \param node The xmlNode to examine
+      \param atts the bag to add to.
+
+      Like getAttributes( node ), but without copying the values: they are
+      taken from the xml tree, when stored in one text node, as usual.
+    */
+    if ( !node ){
+      return;
+    }
+    for ( const xmlAttr *a = node->properties; a; a = a->next ){
+      string_view name = reinterpret_cast<const char*>( a->name );
+      string_view val;
+      const xmlNode *content = a->children;
+      if ( content
+	   && content->type == XML_TEXT_NODE
+	   && !content->next ){
+	val = reinterpret_cast<const char*>( content->content );
+      }
+      else if ( content ){
+	val = atts.keep( att_content( a ) );
+      }
+      if ( a->atype == XML_ATTRIBUTE_ID && name == "id" ){
+	atts.add( "xml:id", val );
+      }
+      else if ( a->ns == 0 || a->ns->prefix == 0 ){
+	atts.add( name, val );
+      }
+      else if ( string_view( reinterpret_cast<const char*>( a->ns->prefix ) )
+		== "xlink" ){
+	atts.add( atts.keep( "xlink:" + string( name ) ), val );
+      }
+      // all other namespaced attributes are ignored
+    }
+  }
+
   KWargs getAttributes( const xmlNode *node ){
     /// extract a KWargs list from an xmlNode
     /*!
@@ -391,28 +596,9 @@ namespace folia {
 
       special care is taken for xml:id and xlink:* attributes
     */
-    KWargs atts;
-    if ( node ){
-      const xmlAttr *a = node->properties;
-      while ( a ){
-	if ( a->atype == XML_ATTRIBUTE_ID && att_name(a) == "id" ){
-	  atts.add("xml:id",att_content(a));
-	}
-	else if ( a->ns == 0 || a->ns->prefix == 0 ){
-	  atts.add(att_name(a), att_content(a));
-	}
-	else {
-	  string pref = to_string( a->ns->prefix );
-	  string att  = att_name(a);
-	  if ( pref == "xlink" ){
-	    atts.add("xlink:"+att, att_content(a));
-	  }
-	  // all other namespaced attributes are ignored
-	}
-	a = a->next;
-      }
-    }
-    return atts;
+    attribute_bag atts;
+    getAttributes( node, atts );
+    return atts.to_kwargs();
   }
 
   void addAttributes( xmlNode *node,
@@ -425,9 +611,9 @@ namespace folia {
       \param att_dbg do we want to debug? (default false)
       some special care is taken for attributes 'xml:id', 'id' and 'lang'
     */
-    KWargs attribs = atts;
-    string xid = attribs.extract("xml:id");
-    if ( !xid.empty() ){ // xml:id is special
+    // xml:id, lang and id are special, and are added first
+    string xid = atts.lookup("xml:id");
+    if ( !xid.empty() ){
       if ( att_dbg ){
 	cerr << "set xml:id " << xid << endl;
       }
@@ -435,15 +621,15 @@ namespace folia {
 		  XML_XML_ID,
 		  to_xmlChar(xid) );
     }
-    string lang = attribs.extract("lang");
-    if ( !lang.empty() ){ // lang is special too
+    string lang = atts.lookup("lang");
+    if ( !lang.empty() ){
       if ( att_dbg ){
 	cerr << "set lang " << lang << endl;
       }
       xmlNodeSetLang( node,
 		      to_xmlChar(lang) );
     }
-    string id = attribs.extract("id");
+    string id = atts.lookup("id");
     if ( !id.empty() ){
       if ( att_dbg ){
 	cerr << "set id " << id << endl;
@@ -453,7 +639,10 @@ namespace folia {
 		  to_xmlChar(id) );
     }
     // and now the rest
-    for ( const auto& [at,val] : attribs ){
+    for ( const auto& [at,val] : atts ){
+      if ( at == "xml:id" || at == "lang" || at == "id" ){
+	continue;
+      }
       if ( att_dbg ){
 	cerr << "add attribute: [" << at << "," << val << "]" << endl;
       }
@@ -632,36 +821,122 @@ namespace folia {
     return false;
   }
 
+  enum class space_class : unsigned char { KEEP, SPACE, CONTROL };
+
+  static space_class classify_space( UChar c ){
+    /// classify a code unit for normalize_spaces()
+    /*!
+      \param c the code unit
+      \return SPACE for whitespace, CONTROL for (ignored) control characters
+      and KEEP for all others, including the soft hyphen.
+
+      The Latin-1 range is looked up in a table. Only the other code units
+      are handed to ICU.
+    */
+    static const auto latin1 = [](){
+      array<space_class,256> table;
+      for ( UChar k = 0; k < 256; ++k ){
+	if ( k == 0x00ad ){ // soft hyphen
+	  table[k] = space_class::KEEP;
+	}
+	else if ( u_isspace( k ) ){
+	  table[k] = space_class::SPACE;
+	}
+	else if ( u_iscntrl( k ) ){
+	  table[k] = space_class::CONTROL;
+	}
+	else {
+	  table[k] = space_class::KEEP;
+	}
+      }
+      return table;
+    }();
+    if ( c < 256 ){
+      return latin1[c];
+    }
+    else if ( u_isspace( c ) ){
+      return space_class::SPACE;
+    }
+    else if ( u_iscntrl( c ) ){
+      return space_class::CONTROL;
+    }
+    return space_class::KEEP;
+  }
+
   UnicodeString normalize_spaces( const UnicodeString& input ){
     /// substitute all spaces and control characters by spaces
     /// AND all multiple spaces by 1, also trims at back and front.
     /*!
       \param input the UnicodeString to normalize
-     */
+
+      The (common) part of input that is already normalized is found in a
+      first scan, and returned as is when that is all of it. The rest is
+      written directly into the buffer of the result.
+      Both scans skip runs of plain ASCII using skip_plain_ascii() and
+      skip_ascii_range(), which use SSE2 or AVX2 when available.
+    */
+    const int len = input.length();
+    if ( len == 0 ){
+      return UnicodeString();
+    }
+    const UChar *in = input.getBuffer();
+    int i = 0;
+    while ( ( i = skip_plain_ascii( in, len, i ) ) < len ){
+      // a leading or double space, or not ASCII
+      const UChar c = in[i];
+      if ( c == 0x0020 || classify_space( c ) != space_class::KEEP ){
+	break;
+      }
+      ++i;
+    }
+    if ( i == len && in[len-1] != 0x0020 ){
+      return input;
+    }
     UnicodeString result;
-    UChar32 shy = 0x00ad;   // soft hyphen
-    bool is_space = false;
-    for ( int i=0; i < input.length(); ++i ){
-      if ( input[i] != shy ){
-	if ( u_isspace( input[i] ) ){
-	  if ( is_space ){
-	    // already a space added, skip this one
-	    continue;
-	  }
-	  is_space = true;
-	  result += " ";
-	  continue;
+    UChar *out = result.getBuffer( len );
+    if ( !out ){
+      throw bad_alloc();
+    }
+    int n = i;
+    bool pending = false; // a space is due before the next character
+    if ( n > 0 && in[n-1] == 0x0020 ){
+      --n;
+      pending = true;
+    }
+    copy( in, in+n, out );
+    for ( ; i < len; ++i ){
+      const int run = skip_ascii_range( in, len, i, 0x0021, 0x007e );
+      if ( run > i ){
+	// printable ASCII, but no spaces
+	if ( pending && n > 0 ){
+	  out[n++] = 0x0020;
 	}
-	else if ( u_iscntrl( input[i] ) ){
-	  // ignore
-	  continue;
+	pending = false;
+	copy( in+i, in+run, out+n );
+	n += run - i;
+	i = run;
+	if ( i == len ){
+	  break;
 	}
       }
-      // normal character, keep it
-      is_space = false;
-      result += input[i];
+      const UChar c = in[i];
+      switch ( classify_space( c ) ){
+      case space_class::KEEP:
+	if ( pending && n > 0 ){
+	  out[n++] = 0x0020;
+	}
+	pending = false;
+	out[n++] = c;
+	break;
+      case space_class::SPACE:
+	pending = true;
+	break;
+      case space_class::CONTROL:
+	// ignore
+	break;
+      }
     }
-    result.trim(); // remove leading and trailing whitespace;
+    result.releaseBuffer( n );
     return result;
   }
 
@@ -845,9 +1120,486 @@ namespace folia {
 	}
       }
     }
+    for ( auto const& [old_tag,new_tag] : oldtags ){
+      if ( stringToElementType( old_tag ) != stringToElementType( new_tag ) ){
+	cerr << "old tag " << old_tag << " doesn't map to " << new_tag << endl;
+	sane = false;
+      }
+    }
+    if ( !contained_types( ElementType::Sentence_t ).test( size_t(ElementType::Word_t) )
+	 || !contained_types( ElementType::Text_t ).test( size_t(ElementType::TextContent_t) )
+	 || contained_types( ElementType::XmlText_t ).test( size_t(ElementType::Word_t) )
+	 || contained_types( ElementType::PosAnnotation_t ).test( size_t(ElementType::Word_t) ) ){
+      cerr << "contained_types() is wrong" << endl;
+      sane = false;
+    }
+    for ( const auto& bad : { "", "x", "wref ", "Word", "alignments" } ){
+      try {
+	stringToElementType( bad );
+	cerr << "stringToElementType accepted '" << bad << "'" << endl;
+	sane = false;
+      }
+      catch ( const ValueError& ){
+      }
+    }
     return sane;
   }
 
+  static bool pipe_sanity_check( const string& xml ){
+    /// read a Document from a named pipe, which can't be memory mapped
+    const string fifo = "/tmp/folia_sanity_" + TiCC::toString( getpid() )
+      + ".fifo";
+    for ( const auto& mode : { "mode='nochecktext'", "mode='stream'" } ){
+      if ( mkfifo( fifo.c_str(), 0600 ) != 0 ){
+	cerr << " unable to create a pipe, skipping the pipe test" << endl;
+	return true;
+      }
+      thread writer( [&](){
+	ofstream os( fifo );
+	os << xml;
+      } );
+      Document pd( mode );
+      bool ok = false;
+      try {
+	ok = pd.read_from_file( fifo );
+      }
+      catch ( const exception& e ){
+	cerr << " " << e.what() << endl;
+      }
+      writer.join();
+      unlink( fifo.c_str() );
+      if ( !ok || pd.xmlstring() != xml ){
+	cerr << " reading from a pipe failed in " << mode << endl;
+	return false;
+      }
+    }
+    return true;
+  }
+
+  static bool write_fixture( const string& name,
+			     const unsigned char *bytes, size_t len ){
+    /// write len bytes to a scratch file for the decompression test
+    ofstream os( name, ios::binary );
+    os.write( reinterpret_cast<const char*>(bytes), len );
+    return os.good();
+  }
+
+  static bool compressed_read_fails( const string& name, const char *mode ){
+    /// reading a corrupt compressed file must throw a DocumentError
+    /// in stream mode this error is rethrown by check_decompress_error()
+    try {
+      Document cd( mode );
+      cd.read_from_file( name );
+    }
+    catch ( const DocumentError& ){
+      return true;
+    }
+    catch ( const exception& e ){
+      cerr << " wrong exception: " << e.what() << endl;
+    }
+    return false;
+  }
+
+  static bool compression_sanity_check(){
+    /// read small gzip, bzip2, xz and zstd fixtures of the same Document
+    /// formats that are not configured are skipped
+    const string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<FoLiA xmlns=\"http://ilk.uvt.nl/folia\" xml:id=\"zip\" version=\"2.5.0\">"
+      "<metadata type=\"native\"><annotations><text-annotation/>"
+      "<token-annotation/><sentence-annotation/></annotations></metadata>"
+      "<text xml:id=\"zip.text\"><s xml:id=\"zip.s\">"
+      "<w xml:id=\"zip.w1\"><t>Ingepakt</t></w>"
+      "<w xml:id=\"zip.w2\"><t>bestand</t></w></s></text></FoLiA>\n";
+    static const unsigned char zip_fixture_gz[] = {
+      0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x65, 0x90,
+      0x41, 0x6a, 0xc3, 0x30, 0x10, 0x45, 0xf7, 0x3e, 0x85, 0x99, 0x7d, 0xa4,
+      0x26, 0x10, 0x08, 0x46, 0x52, 0xe8, 0x26, 0x50, 0xc8, 0x32, 0x3d, 0x80,
+      0x52, 0x4f, 0x5d, 0x61, 0x67, 0x64, 0xaa, 0xa9, 0x9d, 0xf4, 0xf4, 0x19,
+      0x27, 0x34, 0x8e, 0xe8, 0x4a, 0xe8, 0xe9, 0xf3, 0xfe, 0x47, 0x66, 0x7b,
+      0x3e, 0x75, 0xe5, 0x80, 0xdf, 0x29, 0x44, 0xb2, 0xb0, 0x54, 0x2f, 0x50,
+      0x22, 0x7d, 0xc4, 0x3a, 0x50, 0x63, 0xe1, 0xfd, 0xb0, 0x5b, 0x6c, 0x60,
+      0xeb, 0x0a, 0xb3, 0x8b, 0xfb, 0xf0, 0x5a, 0x4a, 0x96, 0x92, 0x85, 0x2f,
+      0xe6, 0xbe, 0xd2, 0x3a, 0x74, 0xad, 0xfa, 0x19, 0x58, 0x51, 0xa7, 0x3f,
+      0x63, 0x17, 0x3c, 0x4c, 0xef, 0x55, 0xa8, 0x2d, 0xfc, 0x86, 0x1e, 0x66,
+      0xe9, 0x4a, 0xad, 0x45, 0xeb, 0xcc, 0x09, 0xd9, 0xd7, 0x9e, 0x7d, 0xc9,
+      0x97, 0x1e, 0x2d, 0x90, 0xe7, 0x30, 0xa0, 0x70, 0x4f, 0x14, 0x59, 0x2e,
+      0x91, 0x92, 0x33, 0x8c, 0x67, 0x5e, 0xcc, 0x44, 0x0b, 0x89, 0x2d, 0x52,
+      0x8e, 0x12, 0x12, 0xcb, 0x4a, 0xcc, 0xa9, 0xce, 0x44, 0xfa, 0xaf, 0xee,
+      0xee, 0x7c, 0xde, 0xa6, 0x26, 0x20, 0xc5, 0x29, 0x83, 0x49, 0xc8, 0x98,
+      0x91, 0x71, 0x29, 0x88, 0xdd, 0x1b, 0x35, 0xd8, 0xfb, 0x96, 0x8d, 0x66,
+      0xd1, 0x8e, 0xff, 0x52, 0xab, 0x5b, 0xea, 0x88, 0x89, 0x3d, 0xd5, 0x8f,
+      0x90, 0x9e, 0x36, 0x4c, 0x45, 0x72, 0xdc, 0x7e, 0xcf, 0x15, 0x57, 0x56,
+      0xc1, 0xea, 0x26, 0x6d, 0x01, 0x00, 0x00
+    };
+
+    static const unsigned char zip_fixture_bz2[] = {
+      0x42, 0x5a, 0x68, 0x39, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0x5c, 0xa3,
+      0x09, 0xbc, 0x00, 0x00, 0x29, 0xdf, 0x80, 0x00, 0x10, 0x50, 0x03, 0xf2,
+      0x57, 0xa1, 0x24, 0x06, 0x00, 0x3f, 0xef, 0xdf, 0xf0, 0x30, 0x00, 0xcd,
+      0xa0, 0x6a, 0x46, 0x86, 0x40, 0x01, 0xa3, 0x20, 0x00, 0xc8, 0x01, 0x08,
+      0x4d, 0x19, 0x1a, 0x03, 0x40, 0x00, 0x68, 0xd0, 0x00, 0x49, 0x24, 0x3d,
+      0x22, 0x9e, 0xd2, 0x8f, 0xca, 0x9b, 0x53, 0x1a, 0x4f, 0x44, 0x68, 0x7a,
+      0x8d, 0x34, 0xf2, 0x92, 0x02, 0xd7, 0x9b, 0x61, 0x6c, 0xec, 0x22, 0x36,
+      0x1d, 0x03, 0x27, 0x0d, 0x3d, 0x10, 0x54, 0x60, 0x02, 0x4e, 0xb3, 0x9e,
+      0xb7, 0xcb, 0x10, 0xe1, 0xa0, 0x93, 0x11, 0x42, 0x95, 0x36, 0x45, 0x91,
+      0x8f, 0xa3, 0x34, 0x32, 0xba, 0x28, 0xe0, 0x1d, 0x70, 0x82, 0xc8, 0x64,
+      0x89, 0x1f, 0x3c, 0x31, 0x8a, 0x39, 0x67, 0x75, 0x1e, 0x6d, 0x51, 0x35,
+      0x5b, 0x1e, 0xb5, 0x98, 0xc7, 0x38, 0x16, 0x66, 0x86, 0x65, 0x76, 0x3e,
+      0x01, 0x8f, 0x21, 0x04, 0x19, 0xc9, 0x40, 0xa1, 0x32, 0x03, 0x82, 0x0b,
+      0x80, 0x82, 0x81, 0x08, 0xc1, 0x5d, 0xb5, 0x56, 0xa5, 0x8b, 0xaa, 0x26,
+      0x9d, 0x87, 0x0a, 0x78, 0x9b, 0xbe, 0xcc, 0xfa, 0x22, 0xcc, 0x62, 0xa4,
+      0x31, 0xb2, 0x19, 0xfc, 0xf7, 0x4a, 0x4c, 0x8a, 0xb1, 0x86, 0xfb, 0xf5,
+      0x4b, 0xa3, 0xa2, 0x70, 0x2e, 0xb7, 0xb7, 0x5a, 0x91, 0x7a, 0x25, 0x69,
+      0x1d, 0x0e, 0x5e, 0x5f, 0xb7, 0xa5, 0x6a, 0x19, 0x15, 0x3e, 0xcc, 0x4e,
+      0x4e, 0x4d, 0xaa, 0xd4, 0xb2, 0x8b, 0x2c, 0xe1, 0x11, 0xca, 0x0e, 0x6f,
+      0xa2, 0x3c, 0x2c, 0xbd, 0xa3, 0x11, 0x43, 0x0d, 0x79, 0xbc, 0xe0, 0x6c,
+      0xe5, 0x65, 0xa6, 0x96, 0x0b, 0x00, 0xbb, 0x8a, 0x3f, 0xc5, 0xdc, 0x91,
+      0x4e, 0x14, 0x24, 0x17, 0x28, 0xc2, 0x6f, 0x00
+    };
+
+    static const unsigned char zip_fixture_xz[] = {
+      0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x04, 0xe6, 0xd6, 0xb4, 0x46,
+      0x04, 0xc0, 0xdf, 0x01, 0xed, 0x02, 0x21, 0x01, 0x1c, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x16, 0x26, 0x2a, 0x81, 0xe0, 0x01, 0x6c, 0x00,
+      0xd7, 0x5d, 0x00, 0x1e, 0x0f, 0xcb, 0x87, 0x11, 0xd8, 0xce, 0x66, 0x91,
+      0x0f, 0x83, 0x1e, 0xca, 0xfd, 0x7b, 0x33, 0xd4, 0x7f, 0xe9, 0xb7, 0xda,
+      0x28, 0x31, 0x76, 0x25, 0x66, 0x20, 0x4d, 0x2a, 0x09, 0x6d, 0x6a, 0xf7,
+      0x29, 0x70, 0x38, 0x30, 0xe7, 0xcc, 0x1d, 0x56, 0x13, 0xca, 0xc1, 0x45,
+      0x11, 0x8b, 0x34, 0xd6, 0xc7, 0x07, 0x92, 0x10, 0xdf, 0x7b, 0x5a, 0x08,
+      0x12, 0xa2, 0x89, 0x02, 0xdf, 0x26, 0x25, 0x9c, 0x91, 0x88, 0xfa, 0x80,
+      0xb4, 0x6d, 0xd8, 0xb7, 0xbc, 0x86, 0x70, 0x04, 0x10, 0x76, 0x8d, 0xce,
+      0xd8, 0xf6, 0x5b, 0xf4, 0x46, 0xa4, 0x81, 0x4e, 0xdb, 0x67, 0x5c, 0x41,
+      0xe1, 0xb6, 0x82, 0x9b, 0xfd, 0x65, 0x41, 0x0f, 0xd3, 0xb6, 0xdc, 0x0a,
+      0x31, 0x1b, 0x47, 0x6b, 0x3d, 0x1f, 0xe6, 0xc7, 0xd9, 0x1e, 0x92, 0xeb,
+      0x18, 0x2e, 0x09, 0x93, 0x38, 0x29, 0x13, 0x92, 0xab, 0x2e, 0x2e, 0x95,
+      0xd8, 0xba, 0xee, 0xb3, 0xb4, 0x40, 0xaf, 0xe3, 0x80, 0xd3, 0x12, 0x10,
+      0x7c, 0x25, 0x7a, 0x9d, 0x61, 0x63, 0xcd, 0xe8, 0x14, 0x43, 0x7e, 0x13,
+      0x81, 0xcf, 0x4f, 0x35, 0xbc, 0x7f, 0x42, 0xa5, 0x03, 0xc1, 0x34, 0x06,
+      0x78, 0x20, 0x77, 0xfc, 0x67, 0x2e, 0xf9, 0xdb, 0xd9, 0xcf, 0x37, 0x60,
+      0x3e, 0x87, 0xe4, 0x90, 0x6c, 0x3f, 0x31, 0x08, 0x48, 0xf4, 0xd0, 0x95,
+      0x13, 0x9e, 0x6f, 0x6d, 0x7c, 0x45, 0x7a, 0x91, 0xb3, 0x11, 0x61, 0x69,
+      0xe7, 0x27, 0x4f, 0x7e, 0x44, 0xef, 0xdb, 0xe1, 0x7d, 0xa2, 0x6a, 0x76,
+      0x80, 0x00, 0x00, 0x00, 0xa8, 0xef, 0x06, 0x8f, 0xa6, 0x98, 0x1f, 0x8f,
+      0x00, 0x01, 0xfb, 0x01, 0xed, 0x02, 0x00, 0x00, 0x3c, 0x59, 0xf1, 0xa6,
+      0xb1, 0xc4, 0x67, 0xfb, 0x02, 0x00, 0x00, 0x00, 0x00, 0x04, 0x59, 0x5a
+    };
+
+    static const unsigned char zip_fixture_zst[] = {
+      0x28, 0xb5, 0x2f, 0xfd, 0x64, 0x6d, 0x00, 0x6d, 0x06, 0x00, 0xe2, 0x4b,
+      0x25, 0x19, 0x60, 0x79, 0x03, 0xff, 0x98, 0x60, 0xc8, 0x8a, 0x5e, 0xdf,
+      0xd8, 0xc2, 0x2d, 0xeb, 0x10, 0xe4, 0xa2, 0xda, 0x66, 0x1c, 0x1e, 0x1d,
+      0x81, 0x41, 0x0e, 0x40, 0x5d, 0xae, 0x83, 0x99, 0xaf, 0x7f, 0x4e, 0x6e,
+      0x3f, 0x77, 0x54, 0x78, 0x93, 0xd6, 0x9f, 0xf4, 0x2f, 0xab, 0x75, 0xe5,
+      0x4d, 0x7d, 0xc2, 0xf3, 0x72, 0xa6, 0x35, 0xca, 0x39, 0x5b, 0xf2, 0x7e,
+      0xef, 0xec, 0x7d, 0xe1, 0x29, 0xfc, 0xd7, 0x4f, 0x6b, 0x76, 0x7c, 0xdf,
+      0x3e, 0x76, 0xb7, 0xdd, 0xdd, 0xb7, 0x1e, 0x93, 0xd6, 0xc0, 0x0f, 0xec,
+      0xdb, 0xc9, 0x7e, 0x67, 0xb4, 0xc6, 0x41, 0x1a, 0xb2, 0x88, 0xda, 0x0d,
+      0x63, 0x32, 0x5d, 0x24, 0xda, 0x8b, 0x61, 0x6a, 0x62, 0x2e, 0xbf, 0xe3,
+      0xe4, 0x85, 0xdd, 0x39, 0x11, 0xed, 0xdf, 0x8a, 0x49, 0xf6, 0x60, 0xb9,
+      0x0e, 0x66, 0x28, 0x50, 0x95, 0x78, 0x08, 0xcc, 0x03, 0xc5, 0xa4, 0xf2,
+      0x3b, 0x61, 0xc9, 0x3b, 0x88, 0x83, 0x24, 0x62, 0xe2, 0xf8, 0xe6, 0xad,
+      0xbb, 0x00, 0xcb, 0x3e, 0x85, 0x06, 0x16, 0x20, 0x60, 0xc2, 0x76, 0x77,
+      0x92, 0x98, 0x83, 0xc2, 0x45, 0x97, 0xfd, 0xba, 0xd3, 0x79, 0xd9, 0x01,
+      0x74, 0xb0, 0x0a, 0x08, 0xe4, 0x88, 0x1c, 0xdc, 0x47, 0x3c, 0x2e, 0x06,
+      0xc8, 0x21, 0x8e, 0x71, 0xb0, 0x44, 0x8e, 0x96, 0x9c, 0x03, 0xa6, 0x6c,
+      0xb6, 0x1d, 0x64, 0xec, 0x2b, 0x19, 0x5b, 0xd9, 0x0f, 0xa8, 0x7a, 0x33,
+      0xca, 0x87, 0x1b
+    };
+
+    struct fixture {
+      Compression comp;
+      const unsigned char *bytes;
+      size_t len;
+    };
+    const fixture fixtures[] = {
+      { Compression::GZIP, zip_fixture_gz, sizeof(zip_fixture_gz) },
+      { Compression::BZIP2, zip_fixture_bz2, sizeof(zip_fixture_bz2) },
+      { Compression::XZ, zip_fixture_xz, sizeof(zip_fixture_xz) },
+      { Compression::ZSTD, zip_fixture_zst, sizeof(zip_fixture_zst) }
+    };
+    // no extension: the format must be detected from the magic bytes
+    const string name = "/tmp/folia_sanity_" + TiCC::toString( getpid() );
+    bool sane = true;
+    for ( const auto& f : fixtures ){
+      if ( detect_compression( f.bytes, f.len ) != f.comp ){
+	cerr << " " << toString( f.comp ) << " magic not detected" << endl;
+	sane = false;
+	continue;
+      }
+      if ( !has_decompressor( f.comp ) ){
+	cerr << " no " << toString( f.comp ) << " support, skipped" << endl;
+	continue;
+      }
+      for ( const auto& mode : { "mode='nochecktext'", "mode='stream'" } ){
+	Document plain( mode );
+	plain.read_from_string( xml );
+	const string expect = plain.xmlstring();
+	if ( !write_fixture( name, f.bytes, f.len ) ){
+	  cerr << " unable to write " << name << endl;
+	  return true;
+	}
+	if ( detect_compression( name ) != f.comp ){
+	  cerr << " " << toString( f.comp ) << " file not detected" << endl;
+	  sane = false;
+	}
+	try {
+	  Document cd( mode );
+	  if ( !cd.read_from_file( name )
+	       || cd.xmlstring() != expect ){
+	    cerr << " " << toString( f.comp ) << " round trip failed in "
+		 << mode << endl;
+	    sane = false;
+	  }
+	}
+	catch ( const exception& e ){
+	  cerr << " " << toString( f.comp ) << " in " << mode << ": "
+	       << e.what() << endl;
+	  sane = false;
+	}
+	write_fixture( name, f.bytes, f.len/2 );
+	if ( !compressed_read_fails( name, mode ) ){
+	  cerr << " truncated " << toString( f.comp ) << " accepted in "
+	       << mode << endl;
+	  sane = false;
+	}
+	vector<unsigned char> tail( f.bytes, f.bytes + f.len );
+	const string garbage = "garbage";
+	tail.insert( tail.end(), garbage.begin(), garbage.end() );
+	write_fixture( name, tail.data(), tail.size() );
+	if ( !compressed_read_fails( name, mode ) ){
+	  cerr << " trailing garbage after " << toString( f.comp )
+	       << " accepted in " << mode << endl;
+	  sane = false;
+	}
+      }
+    }
+    unlink( name.c_str() );
+    return sane;
+  }
+
+  static bool found_words( const vector<vector<Word*> >& found,
+			   const vector<vector<string> >& expect ){
+    /// compare the result of a findwords() with a list of expected id's
+    /// an empty id stands for a missing context Word (0)
+    if ( found.size() != expect.size() ){
+      return false;
+    }
+    for ( size_t i=0; i < found.size(); ++i ){
+      if ( found[i].size() != expect[i].size() ){
+	return false;
+      }
+      for ( size_t j=0; j < found[i].size(); ++j ){
+	const Word *w = found[i][j];
+	if ( ( w ? w->id() : "" ) != expect[i][j] ){
+	  return false;
+	}
+      }
+    }
+    return true;
+  }
+
+  static bool findwords_sanity_check(){
+    /// run findwords() on a small Document with known results
+    Document d( "xml:id='fw'" );
+    FoliaElement *txt = d.addText( getArgs( "xml:id='fw.text'" ) );
+    FoliaElement *s = new Sentence( getArgs( "xml:id='fw.s'" ), &d );
+    txt->append( s );
+    int i = 0;
+    for ( const auto& val : { "De", "kat", "zit", "op", "de", "mat",
+			      "en", "de", "Kat", "slaapt", "." } ){
+      KWargs kw;
+      kw.add( "text", val );
+      kw.add( "xml:id", "w" + TiCC::toString( i++ ) );
+      s->addWord( kw );
+    }
+    if ( !found_words( d.findwords( Pattern( { "de", "kat" } ) ),
+		       { { "w0", "w1" }, { "w7", "w8" } } )
+	 || !found_words( d.findwords( Pattern( { "DE", "KAT" } ) ),
+			  { { "w0", "w1" }, { "w7", "w8" } } )
+	 || !found_words( d.findwords( Pattern( { "de", "kat" },
+						"casesensitive='true'" ) ),
+			  {} )
+	 || !found_words( d.findwords( Pattern( { "de", "Kat" },
+						"casesensitive='true'" ) ),
+			  { { "w7", "w8" } } ) ){
+      cerr << " findwords() case (in)sensitive matching failed" << endl;
+      return false;
+    }
+    if ( !found_words( d.findwords( Pattern( { "kat", "*", "mat" } ) ),
+		       { { "w1", "w2", "w3", "w4", "w5" } } )
+	 || !found_words( d.findwords( Pattern( { "kat", "*", "mat" },
+						"maxgapsize='2'" ) ),
+			  {} )
+	 || !found_words( d.findwords( Pattern( { "kat", "*", "slaapt" } ) ),
+			  { { "w1", "w2", "w3", "w4", "w5", "w6", "w7", "w8", "w9" },
+			    { "w8", "w9" } } )
+	 || !found_words( d.findwords( Pattern( { "de", "*:1", "en" } ) ),
+			  { { "w4", "w5", "w6" } } ) ){
+      cerr << " findwords() with gaps failed" << endl;
+      return false;
+    }
+    if ( !found_words( d.findwords( Pattern( { "mat" } ),
+				    "leftcontext='2', rightcontext='3'" ),
+		       { { "w3", "w4", "w5", "w6", "w7", "w8" } } )
+	 || !found_words( d.findwords( Pattern( { "De" } ), "leftcontext='2'" ),
+			  { { "", "", "w0" },
+			    { "w2", "w3", "w4" },
+			    { "w5", "w6", "w7" } } )
+	 || !found_words( d.findwords( Pattern( { "slaapt" } ),
+				       "rightcontext='2'" ),
+			  { { "w9", "w10", "" } } ) ){
+      cerr << " findwords() with leftcontext or rightcontext failed" << endl;
+      return false;
+    }
+    list<Pattern> differ;
+    differ.emplace_back( vector<string>{ "de", "kat" } );
+    differ.emplace_back( vector<string>{ "de", "mat" } );
+    list<Pattern> same;
+    same.emplace_back( vector<string>{ "de", "kat" } );
+    same.emplace_back( vector<string>{ "de", "regexp('[kK]at')" } );
+    list<Pattern> wild;
+    wild.emplace_back( vector<string>{ "de", "*" } );
+    wild.emplace_back( vector<string>{ "de", "*" } );
+    list<Pattern> mixed;
+    mixed.emplace_back( vector<string>{ "de", "*" } );
+    mixed.emplace_back( vector<string>{ "de", "kat" } );
+    if ( !found_words( d.findwords( differ ), {} )
+	 || !found_words( d.findwords( same, "rightcontext='1'" ),
+			  { { "w0", "w1", "w2" }, { "w7", "w8", "w9" } } )
+	 || !found_words( d.findwords( wild ),
+			  { { "w0", "w1" }, { "w4", "w5" }, { "w7", "w8" } } )
+	 || !found_words( d.findwords( mixed ), {} ) ){
+      cerr << " findwords() with a list of Patterns failed" << endl;
+      return false;
+    }
+    return true;
+  }
+
+  static string parallel_parse( const string& mode, const string& body,
+				Document& doc ){
+    /// parse a small Document with the given body, return the result
+    /// as xml, or the error message
+    const string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<FoLiA xmlns=\"http://ilk.uvt.nl/folia\" xml:id=\"par\" version=\"2.5.0\">"
+      "<metadata type=\"native\"><annotations><text-annotation/>"
+      "<token-annotation/><sentence-annotation/><paragraph-annotation/>"
+      "<pos-annotation set=\"tagset\"/><entity-annotation set=\"entset\"/>"
+      "</annotations></metadata><text xml:id=\"par.text\">"
+      + body + "</text></FoLiA>\n";
+    doc.setmode( mode );
+    try {
+      doc.read_from_string( xml );
+      return doc.xmlstring();
+    }
+    catch ( const exception& e ){
+      return string( "error: " ) + e.what();
+    }
+  }
+
+  static string parallel_paragraph( const string& n,
+				    const string& extra = "" ){
+    /// a Paragraph for the parallel tests, with a Sentence of 2 Words
+    const string id = "par.p" + n;
+    return "<p xml:id=\"" + id + "\"><s xml:id=\"" + id + ".s\">"
+      "<w xml:id=\"" + id + ".w1\"><t>woord</t><pos class=\"N\"/></w>"
+      "<w xml:id=\"" + id + ".w2\"><t>" + n + "</t><pos class=\"TW\"/></w>"
+      + extra + "</s></p>";
+  }
+
+  static bool parallel_sanity_check(){
+    /// a 'parallel:2' parse must give the same result as a serial parse,
+    /// also when it has to fall back to serial parsing, or fails
+    struct parallel_case {
+      string name;
+      string mode;
+      string body;
+      bool fails;
+    };
+    const vector<parallel_case> cases = {
+      { "plain", "",
+	parallel_paragraph( "1" ) + parallel_paragraph( "2" )
+	+ parallel_paragraph( "3" ), false },
+      // libxml2 already rejects this, before the subtrees are parsed
+      { "duplicate id", "",
+	parallel_paragraph( "1" ) + parallel_paragraph( "2" )
+	+ "<p xml:id=\"par.p3\"><s xml:id=\"par.p1.s\"/></p>", true },
+      // these 2 make a subtree fall back to a serial parse
+      { "wref into another subtree", "",
+	parallel_paragraph( "1" ) + parallel_paragraph( "2" )
+	+ parallel_paragraph( "3", "<entities><entity class=\"x\">"
+			      "<wref id=\"par.p1.w1\" t=\"woord\"/>"
+			      "<wref id=\"par.p3.w1\" t=\"woord\"/>"
+			      "</entity></entities>" ), false },
+      { "autodeclaration", "autodeclare,",
+	parallel_paragraph( "1" )
+	+ parallel_paragraph( "2", "<w xml:id=\"par.p2.w3\"><t>x</t>"
+			      "<str><t>x</t></str></w>" )
+	+ parallel_paragraph( "3" ), false },
+      { "error in a subtree", "",
+	parallel_paragraph( "1" ) + parallel_paragraph( "2", "ouch" )
+	+ parallel_paragraph( "3" ), true }
+    };
+    for ( const auto& c : cases ){
+      Document serial;
+      Document parallel;
+      const string expect = parallel_parse( c.mode + "noparallel",
+					    c.body, serial );
+      const string result = parallel_parse( c.mode + "parallel:2",
+					    c.body, parallel );
+      if ( result != expect ){
+	cerr << " parallel parse differs, " << c.name << ":\n"
+	     << expect << "\n" << result << endl;
+	return false;
+      }
+      if ( TiCC::match_front( result, "error:" ) != c.fails ){
+	cerr << " unexpected parse result, " << c.name << ": "
+	     << result << endl;
+	return false;
+      }
+      // a failed parse leaves no (partial) tree behind
+      if ( c.fails && ( serial.doc() || parallel.doc() ) ){
+	cerr << " parse left a partial tree, " << c.name << endl;
+	return false;
+      }
+    }
+    return true;
+  }
+
+  static bool arena_sanity_check(){
+    /// an 'arena' Document must give the same result as a normal one, and
+    /// nodes taken out of it must survive deleting the Document
+    const string body = parallel_paragraph( "1" ) + parallel_paragraph( "2" );
+    Document normal;
+    const string expect = parallel_parse( "", body, normal );
+    Document *ad = new Document();
+    const string result = parallel_parse( "arena", body, *ad );
+    if ( result != expect ){
+      cerr << " arena parse differs:\n" << expect << "\n" << result << endl;
+      delete ad;
+      return false;
+    }
+    FoliaElement *removed = (*ad)["par.p1.w2"];
+    removed->parent()->remove( removed );
+    FoliaElement *old = (*ad)["par.p2.w1"];
+    FoliaElement *replacement = FoliaElement::createElement( "w", ad );
+    FoliaElement *replaced = old->parent()->replace( old, replacement );
+    if ( replaced != old || ad->words().size() != 3 ){
+      cerr << " remove() or replace() failed in arena mode" << endl;
+      delete ad;
+      return false;
+    }
+    delete ad;
+    bool ok = removed->id() == "par.p1.w2" && removed->doc() == 0
+      && replaced->id() == "par.p2.w1" && replaced->str() == "woord";
+    removed->destroy();
+    replaced->destroy();
+    if ( !ok ){
+      cerr << " detached nodes not kept after deleting an arena Document"
+	   << endl;
+    }
+    return ok;
+  }
+
   bool document_sanity_check(){
     cerr << " Creating a document from scratch: ";
     Document d( "xml:id='example'" );
@@ -886,6 +1638,245 @@ namespace folia {
       return EXIT_FAILURE;
     }
     cerr << s->text() << endl;
+    vector<Word*> words = d.words();
+    size_t pos = 0;
+    for ( Word *w : d.each<Word>( default_ignore_structure ) ){
+      if ( pos >= words.size() || words[pos++] != w ){
+	cerr << " each<Word>() does not match words()" << endl;
+	return false;
+      }
+    }
+    size_t visited = 0;
+    bool done = d.for_each<Word>( [&]( Word * ){ return ++visited < 2; } );
+    if ( pos != 5 || done || visited != 2 || d.words(3) != words[3] ){
+      cerr << " for_each<Word>() or words(3) failed" << endl;
+      return false;
+    }
+    kw.replace("text", "!");
+    Word *last = s->addWord( kw );
+    if ( words[4]->next() != last || last->previous() != words[4] ){
+      cerr << " next() not updated after adding a Word" << endl;
+      return false;
+    }
+    if ( d.words().size() != 6 || d.rwords(0) != last || d.words(3) != words[3] ){
+      cerr << " words() not updated after adding a Word" << endl;
+      return false;
+    }
+    s->remove( last );
+    if ( d.words().size() != 5 || d.rwords(0) != words[4] ){
+      cerr << " words() not updated after removing a Word" << endl;
+      return false;
+    }
+    last->destroy();
+    if ( d.sentences().size() != 1 ){
+      cerr << " sentences() failed" << endl;
+      return false;
+    }
+    FoliaElement *s2 = new Sentence( getArgs( "generate_id='" + txt->id() + "'" ),
+				     &d );
+    kw.replace("text", "Nieuw");
+    Word *extra = s2->addWord( kw );
+    txt->append( s2 );
+    if ( d.sentences().size() != 2 || d.rsentences(0) != s2
+	 || d.words().size() != 6 || d.rwords(0) != extra ){
+      cerr << " words() or sentences() not updated after adding a Sentence"
+	   << endl;
+      return false;
+    }
+    txt->remove( s2 );
+    s2->destroy();
+    if ( d.sentences().size() != 1 || d.words().size() != 5 ){
+      cerr << " words() or sentences() not updated after removing a Sentence"
+	   << endl;
+      return false;
+    }
+    if ( words[2]->previous() != words[1] || words[2]->next() != words[3]
+	 || words[0]->previous() != 0 || words[4]->next() != 0 ){
+      cerr << " previous() or next() failed" << endl;
+      return false;
+    }
+    vector<Word*> ctx = words[1]->context( 2 );
+    if ( ctx.size() != 5 || ctx[0] != 0 || ctx[1] != words[0]
+	 || ctx[4] != words[3] || words[4]->rightcontext( 1 )[0] != 0
+	 || words[1]->leftcontext( 1 )[0] != words[0] ){
+      cerr << " context() failed" << endl;
+      return false;
+    }
+    FoliaElement *layer = s->append( new EntitiesLayer( &d ) );
+    FoliaElement *ent = layer->append( new Entity( getArgs( "class='loc'" ), &d ) );
+    ent->append( words[1] );
+    ent->append( words[2] );
+    vector<AbstractSpanAnnotation*> spans = words[2]->findspans( ElementType::Entity_t );
+    if ( spans.size() != 1 || spans[0] != ent
+	 || !words[0]->findspans( ElementType::Entity_t ).empty()
+	 || layer->findspan( { words[1], words[2] } ) != ent
+	 || layer->findspan( { words[1] } ) != 0 ){
+      cerr << " findspans() or findspan() failed" << endl;
+      return false;
+    }
+    AbstractSpanAnnotation *span = spans[0];
+    span->remove( words[2] );
+    if ( span->wrefs_view().size() != 1 || span->wrefs(1) != 0
+	 || !words[2]->findspans( ElementType::Entity_t ).empty()
+	 || layer->findspan( { words[1] } ) != ent ){
+      cerr << " wrefs() not updated after removing a Word" << endl;
+      return false;
+    }
+    if ( !d.span_index_outdated()
+	 || d.spans_of( words[1] ).size() != 1
+	 || !d.spans_of( words[2] ).empty()
+	 || d.span_index_outdated()
+	 || words[1]->findspans( ElementType::Entity_t ).size() != 1 ){
+      cerr << " spans_of() not rebuilt after removing a Word" << endl;
+      return false;
+    }
+    Pattern rx( { "regexp('s.*')", "regexp('st?aat')" }, "regexp='true'" );
+    vector<vector<Word*> > found = d.findwords( rx );
+    if ( found.size() != 1 || found[0].size() != 2
+	 || found[0][0] != words[1] || found[0][1] != words[2] ){
+      cerr << " findwords() with a regexp failed" << endl;
+      return false;
+    }
+    d.set_cachetext( true );
+    UnicodeString cached = s->text();
+    if ( !d.cachetext() || cached != "De site staat online ."
+	 || s->text() != cached ){
+      cerr << " cached text() does not match" << endl;
+      return false;
+    }
+    kw.replace("text", "!");
+    last = s->addWord( kw );
+    if ( s->text() != "De site staat online . !" ){
+      cerr << " cached text() not updated after adding a Word" << endl;
+      return false;
+    }
+    s->remove( last );
+    last->destroy();
+    if ( s->text() != cached ){
+      cerr << " cached text() not updated after removing a Word" << endl;
+      return false;
+    }
+    // filling the cache in one thread, while another one reads the other
+    // attributes of the node, is fine
+    last = s->addWord( kw );
+    s->remove( last );
+    last->destroy();
+    UnicodeString threaded;
+    thread filler( [&](){ threaded = s->text(); } );
+    bool plain = true;
+    for ( int i=0; i < 1000; ++i ){
+      plain = plain && s->n().empty() && s->confidence() == -1;
+    }
+    filler.join();
+    if ( !plain || threaded != cached ){
+      cerr << " cached text() from another thread failed" << endl;
+      return false;
+    }
+    d.set_cachetext( false );
+    string xml = d.xmlstring();
+    Document sd( "mode='stream'" );
+    if ( !sd.read_from_string( xml )
+	 || sd.xmlstring() != xml ){
+      cerr << " Streaming parse does not match the original document" << endl;
+      return false;
+    }
+    if ( !pipe_sanity_check( xml ) ){
+      return false;
+    }
+    if ( !compression_sanity_check() ){
+      return false;
+    }
+    const string incons = "<?xml version=\"1.0\"?>"
+      "<FoLiA xmlns=\"http://ilk.uvt.nl/folia\" xml:id=\"incons\" version=\"2.5.0\">"
+      "<metadata><annotations><text-annotation/><token-annotation/>"
+      "<sentence-annotation/><paragraph-annotation/></annotations></metadata>"
+      "<text xml:id=\"incons.text\"><p xml:id=\"incons.p\"><t>De site staat</t>"
+      "<s xml:id=\"incons.s\"><t>De site staat</t><w><t>De</t></w>"
+      "<w><t>sites</t></w><w><t>staat</t></w></s></p></text></FoLiA>";
+    try {
+      Document id;
+      id.read_from_string( incons );
+      cerr << " inconsistent text not detected while parsing" << endl;
+      return false;
+    }
+    catch ( const InconsistentText& ){
+    }
+    Document fd( "mode='fixtext'" );
+    if ( !fd.read_from_string( incons )
+	 || fd["incons.s"]->stricttext() != "De sites staat"
+	 || fd["incons.p"]->stricttext() != "De sites staat" ){
+      cerr << " fixtext while parsing failed" << endl;
+      return false;
+    }
+    string utf8 = "<";
+    TextPolicy tp( "current" );
+    words[1]->text_utf8( tp, utf8 );
+    s->text_utf8( tp, utf8 );
+    if ( utf8 != "<site" + s->str( tp ) ){
+      cerr << " text_utf8() does not match str()" << endl;
+      return false;
+    }
+    Word *sw = new Word( &d );
+    sw->settext( " De\n  site\t" );
+    if ( sw->text() != "De site"
+	 || sw->text( "current", TEXT_FLAGS::NO_TRIM_SPACES ) != " De\n  site\t" ){
+      cerr << " trimming the text of a Word failed" << endl;
+      return false;
+    }
+    sw->destroy();
+    FoliaElement *para = new Paragraph( &d );
+    try {
+      s->insert_after( words[1], para );
+      cerr << " insert_after() accepted a Paragraph in a Sentence" << endl;
+      return false;
+    }
+    catch ( const ValueError& ){
+    }
+    try {
+      s->replace( words[1], para );
+      cerr << " replace() accepted a Paragraph in a Sentence" << endl;
+      return false;
+    }
+    catch ( const ValueError& ){
+    }
+    para->destroy();
+    size_t pooled = interned_string::pool_size();
+    {
+      interned_string is1 = "sanity-check-value";
+      interned_string is2 = is1;
+      interned_string is3( string("sanity-check-value") );
+      if ( is1 != is3 || interned_string::pool_size() != pooled + 1 ){
+	cerr << " interning a value failed" << endl;
+	return false;
+      }
+      is1.clear();
+      is2 = "other-sanity-check-value";
+    }
+    if ( interned_string::pool_size() != pooled ){
+      cerr << " unused interned values are not released" << endl;
+      return false;
+    }
+    KWargs args = getArgs( "c='3', a='1', b='2'" );
+    map<string,string>& as_map = args;
+    for ( auto& [att,val] : as_map ){
+      val += att;
+    }
+    if ( args.lower_bound( "b" )->second != "2b"
+	 || args.rbegin()->first != "c"
+	 || toString( args ) != "a='1a',b='2b',c='3c'" ){
+      cerr << " KWargs is not usable as a std::map: " << toString( args )
+	   << endl;
+      return false;
+    }
+    if ( !findwords_sanity_check() ){
+      return false;
+    }
+    if ( !parallel_sanity_check() ){
+      return false;
+    }
+    if ( !arena_sanity_check() ){
+      return false;
+    }
     d.setdebug( "ANNOTATIONS|SERIALIZE" );
     assert( toString(d.debug) == "ANNOTATIONS|SERIALIZE" );
     return true;
@@ -962,7 +1953,57 @@ namespace folia {
       cerr << "is_norm_empty() failed." << endl;
       return false;
     }
-    return true;
+    dirty = u"a\u00A0\u00ADb\u0001 c\u3000";
+    clean = normalize_spaces( dirty );
+    wanted = u"a \u00ADb c";
+    if ( clean != wanted || normalize_spaces( wanted ) != wanted ){
+      cerr << "normalize_space() test 5 failed: got:'" << clean << "'"
+	   << "                 but expected:'" << wanted << "'" << endl;
+      return false;
+    }
+    if ( trim_space( "  a\n " ) != "a\n"
+	 || postprocess_spaces( u"\u0001a\u0001b \u0001c" ) != "a b c" ){
+      cerr << "trim_space() or postprocess_spaces() failed." << endl;
+      return false;
+    }
+    // the SSE2 and AVX2 scans must agree with the scalar one, also around
+    // the vector boundaries
+    const SIMD_LEVEL best = simd_level();
+    const vector<UChar> specials = { 0x0020, 0x0009, 0x0001, 0x007f,
+				     0x00a0, 0x00e9, 0x3000 };
+    bool same = true;
+    for ( size_t len = 1; len <= 40 && same; ++len ){
+      for ( size_t pos = 0; pos < len && same; ++pos ){
+	for ( const auto& special : specials ){
+	  UnicodeString line;
+	  for ( size_t i = 0; i < len; ++i ){
+	    line += ( i % 6 == 5 ) ? UChar(0x0020) : UChar('a' + i % 26);
+	  }
+	  line.setCharAt( pos, special );
+	  const UChar *buf = line.getBuffer();
+	  set_simd_level( SIMD_LEVEL::SCALAR );
+	  size_t plain = skip_plain_ascii( buf, len, 0 );
+	  size_t range = skip_ascii_range( buf, len, 1, 0x0021, 0x007e );
+	  UnicodeString norm = normalize_spaces( line );
+	  UnicodeString post = postprocess_spaces( line );
+	  for ( const auto level : { SIMD_LEVEL::SSE2, SIMD_LEVEL::AVX2 } ){
+	    if ( set_simd_level( level ) != level ){
+	      continue;
+	    }
+	    if ( skip_plain_ascii( buf, len, 0 ) != plain
+		 || skip_ascii_range( buf, len, 1, 0x0021, 0x007e ) != range
+		 || normalize_spaces( line ) != norm
+		 || postprocess_spaces( line ) != post ){
+	      cerr << toString( level ) << " whitespace scan differs for '"
+		   << line << "'" << endl;
+	      same = false;
+	    }
+	  }
+	}
+      }
+    }
+    set_simd_level( best );
+    return same;
   }
 
   bool subclass_sanity_check(){
@@ -1036,6 +2077,30 @@ namespace folia {
 	cerr << "Word::isSubClass<Feature>() failed" << endl;
 	return false;
       }
+      if ( !w->is_a( ElementType::Word_t )
+	   || !w->is_a( ElementType::AbstractWord_t )
+	   || !w->is_a( ElementType::AbstractStructureElement_t ) ){
+	cerr << "Word::is_a() failed" << endl;
+	return false;
+      }
+      if ( w->is_a( ElementType::Feature_t )
+	   || w->is_a( ElementType::AbstractFeature_t ) ){
+	cerr << "Word::is_a() accepted a Feature" << endl;
+	return false;
+      }
+    }
+    {
+      // is_a() follows the C++ classes, not is_subtype()
+      Morpheme *m = new Morpheme();
+      bool ok = m->is_a( ElementType::AbstractStructureElement_t )
+	&& m->isSubClass<AbstractStructureElement>()
+	&& !is_subtype( ElementType::Morpheme_t,
+			ElementType::AbstractStructureElement_t );
+      destroy( m );
+      if ( !ok ){
+	cerr << "Morpheme::is_a() failed" << endl;
+	return false;
+      }
     }
     try {
       vector<FoliaElement*> ve;
@@ -1049,4 +2114,28 @@ namespace folia {
     return true;
   }
 
+  bool sizeof_sanity_check(){
+    // guard the size of the most frequent nodes against growing again.
+    // the limits hold for 64-bit platforms with a 32 bytes std::string
+    if ( sizeof(void*) != 8 || sizeof(string) != 32 ){
+      return true;
+    }
+    if ( sizeof(AbstractElement) > 216 ){
+      cerr << "sizeof(AbstractElement) = " << sizeof(AbstractElement)
+	   << " expected at most 216" << endl;
+      return false;
+    }
+    if ( sizeof(Word) > 288 ){
+      cerr << "sizeof(Word) = " << sizeof(Word)
+	   << " expected at most 288" << endl;
+      return false;
+    }
+    if ( sizeof(XmlText) > 248 ){
+      cerr << "sizeof(XmlText) = " << sizeof(XmlText)
+	   << " expected at most 248" << endl;
+      return false;
+    }
+    return true;
+  }
+
 } //namespace folia
@@ -51,6 +51,9 @@ void usage(){
   cerr << "\t\t\t\t (default: false)" << endl;
   cerr << "\t-x --explicit\t\t output explicit FoLiA. (default: false)" << endl;
   cerr << "\t--permissive.\t\t Allow some dubious constructs." << endl;
+  cerr << "\t--stream\t\t parse the input while reading, without building" << endl;
+  cerr << "\t\t\t\t a complete XML tree first. Saves memory on large files." << endl;
+  cerr << "\t--parallel=N\t\t parse the body of the document in N threads." << endl;
   cerr << "\t--warn\t\t\t add some extra warnings about library versions and unused" << endl;
   cerr << "\t\t\t\t annotation declarations" << endl;
   cerr << "\t-c --canonical\t\t output in a predefined order. Makes comparisons easier" << endl;
@@ -69,6 +72,8 @@ int main( int argc, const char* argv[] ){
   bool kanon = false;
   bool autodeclare = false;
   bool do_explicit = false;
+  bool stream = false;
+  string parallel;
   string debug;
   vector<string> fileNames;
   string command;
@@ -76,7 +81,7 @@ int main( int argc, const char* argv[] ){
     TiCC::CL_Options Opts( "hVd:acxo:",
 			   "nochecktext,debug:,permissive,strip,output:,"
 			   "nooutput,help,fixtext,warn,version,canonical,"
-			   "explicit,autodeclare");
+			   "explicit,autodeclare,stream,parallel:");
     Opts.init(argc, argv );
     if ( Opts.extract( 'h' )
 	 || Opts.extract( "help" ) ){
@@ -99,6 +104,8 @@ int main( int argc, const char* argv[] ){
     permissive = Opts.extract("permissive");
     do_explicit = ( Opts.extract("explicit") || Opts.extract('x') );
     warn = Opts.extract("warn");
+    stream = Opts.extract("stream");
+    Opts.extract( "parallel", parallel );
     nooutput = Opts.extract("nooutput");
     fixtext = Opts.extract("fixtext");
     kanon = Opts.extract("canonical") || Opts.extract("KANON");
@@ -159,6 +166,12 @@ int main( int argc, const char* argv[] ){
   else {
     mode += ",noautodeclare"; // the default
   }
+  if ( stream ){
+    mode += ",stream";
+  }
+  if ( !parallel.empty() ){
+    mode += ",parallel:" + parallel;
+  }
   if ( nochecktext ){
     mode += ",nochecktext";
   }
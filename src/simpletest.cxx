@@ -71,5 +71,9 @@ int main() {
   if ( !subclass_sanity_check() ){
     return EXIT_FAILURE;
   }
+  cout << "Sizeof sanity" << endl;
+  if ( !sizeof_sanity_check() ){
+    return EXIT_FAILURE;
+  }
   return EXIT_SUCCESS;
 }
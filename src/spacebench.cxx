@@ -0,0 +1,151 @@
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of libfolia
+
+  libfolia is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  libfolia is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/ticcutils/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+// Times the whitespace helpers at every SIMD_LEVEL the CPU supports.
+// usage: spacebench [rounds]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+#include "libfolia/folia.h"
+#include "libfolia/folia_simd.h"
+
+using namespace std;
+using namespace icu;
+using namespace folia;
+
+static vector<UnicodeString> make_lines( size_t count ){
+  /// a mix of lines like those in FoLiA texts: mostly clean ASCII, some
+  /// with double spaces, tabs, newlines, accents, no-break spaces or the
+  /// \1 markers postprocess_spaces() looks for
+  const vector<UnicodeString> words = {
+    "De", "site", "staat", "online", "en", "wordt", "bijgewerkt", "door",
+    "het", "team", "van", "de", "universiteit", "in", "Nijmegen", "."
+  };
+  const vector<UnicodeString> odd = {
+    "  ", "\t", "\n", u"café", u" ", u"\u0001", u"　"
+  };
+  vector<UnicodeString> lines;
+  unsigned int seed = 42;
+  auto next = [&](){ seed = seed * 1103515245 + 12345; return seed >> 16; };
+  for ( size_t i = 0; i < count; ++i ){
+    UnicodeString line;
+    size_t len = 4 + next() % 40;
+    for ( size_t w = 0; w < len; ++w ){
+      if ( w > 0 ){
+	line += " ";
+      }
+      line += words[next() % words.size()];
+    }
+    if ( i % 4 == 3 ){
+      // a quarter of the lines needs work
+      line.insert( next() % line.length(), odd[next() % odd.size()] );
+    }
+    lines.push_back( line );
+  }
+  return lines;
+}
+
+static double run( const function<UnicodeString(const UnicodeString&)>& f,
+		   const vector<UnicodeString>& lines,
+		   size_t rounds,
+		   vector<UnicodeString>& results ){
+  /// time rounds calls of f on all lines. returns ns per line
+  results.clear();
+  for ( const auto& line : lines ){
+    results.push_back( f( line ) );
+  }
+  size_t check = 0;
+  auto start = chrono::steady_clock::now();
+  for ( size_t r = 0; r < rounds; ++r ){
+    for ( const auto& line : lines ){
+      check += f( line ).length();
+    }
+  }
+  auto end = chrono::steady_clock::now();
+  if ( check == 0 ){
+    cerr << "nothing done?" << endl;
+  }
+  double ns = chrono::duration<double,nano>( end - start ).count();
+  return ns / ( rounds * lines.size() );
+}
+
+int main( int argc, char *argv[] ){
+  size_t rounds = 200;
+  if ( argc > 1 ){
+    rounds = strtoul( argv[1], 0, 10 );
+  }
+  const vector<UnicodeString> lines = make_lines( 10000 );
+  size_t units = 0;
+  for ( const auto& line : lines ){
+    units += line.length();
+  }
+  cout << lines.size() << " lines, " << units << " UTF16 code units, "
+       << rounds << " rounds. Best SIMD level: "
+       << toString( simd_support() ) << endl;
+  const vector<pair<string,function<UnicodeString(const UnicodeString&)>>>
+    helpers = {
+    { "normalize_spaces", normalize_spaces },
+    { "dumb_spaces", dumb_spaces },
+    { "postprocess_spaces", postprocess_spaces },
+    { "trim_space", trim_space }
+  };
+  bool ok = true;
+  for ( const auto& [name,f] : helpers ){
+    vector<UnicodeString> expect;
+    double scalar = 0;
+    for ( const auto level : { SIMD_LEVEL::SCALAR,
+			       SIMD_LEVEL::SSE2,
+			       SIMD_LEVEL::AVX2 } ){
+      if ( set_simd_level( level ) != level ){
+	continue;
+      }
+      vector<UnicodeString> results;
+      double ns = run( f, lines, rounds, results );
+      if ( level == SIMD_LEVEL::SCALAR ){
+	scalar = ns;
+	expect = results;
+      }
+      else if ( results != expect ){
+	cerr << name << ": " << toString( level )
+	     << " results differ from scalar" << endl;
+	ok = false;
+      }
+      cout << setw(20) << left << name << setw(8) << toString( level )
+	   << right << fixed << setprecision(1) << setw(8) << ns
+	   << " ns/line " << setw(8)
+	   << units * 2 / ( ns * lines.size() ) * 1000 << " MB/s  x"
+	   << setprecision(2) << scalar / ns << endl;
+    }
+  }
+  set_simd_level( simd_support() );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}